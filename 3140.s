@@ -1,104 +1,184 @@
-		AREA myData, DATA, READWRITE	
-;global variable in assembly			
-OrigStackPointer DCD 0x00
-		
-		AREA myProg, CODE, READONLY
-;export assembly functions			
-		EXPORT process_terminated
-		EXPORT process_begin
-		EXPORT process_blocked
-		EXPORT PIT0_IRQHandler
-		EXPORT SVC_Handler
-;import C functions
-		IMPORT process_select
-
-		PRESERVE8
-		
-		
-TFLG     EQU 0x4003710C ; TFLG address
-CTRL     EQU 0x40037108 ; Ctrl address
-SHCSR    EQU 0xE000ED20
-	
-SVC_Handler
-	LDR  R1, [SP,#24] ; Read PC of SVC instruction
-	LDRB R0, [R1,#-2] ; Get #N from SVC instruction
-	ADR  R1, SVC_Table
-	LDR  PC, [R1,R0,LSL #2] ; Branch to Nth SVC routine
-
-SVC_Table
-	DCD SVC0_begin
-	DCD SVC1_terminate
-	DCD PIT0_IRQHandler ; Use system tick as SVC2 handler
-
-SVC0_begin
-				PUSH {R4-R11,LR}
-				;******* Store Original Stack Pointer ********
-				LDR R1, =OrigStackPointer
-				STR SP, [R1]
-				;********************************************
-SVC1_terminate
-				
-				MOVS R0, #0
-				B do_process_select
-	
-process_terminated
-				CPSIE i ; Enable global interrupts, just in case   
-				SVC #1 ; SVC1 = process terminated
-				; This SVC shouldn't ever return, as it would mean the process was scheduled again
-
-process_begin
-				CPSIE i ; Enable global interrupts (for SVC)
-				SVC #0 ; Syscall into scheduler
-				BX LR
-
-				
-process_blocked
-				CPSIE i ; Enable global interrupts, just in case   
-				SVC #2 ; SVC2 = process blocked        
-				BX LR
-				
-PIT0_IRQHandler ; Timer Interrupt
-			  CPSID i 			; Disable all interrupts 
-			  PUSH {R4-R11,LR} 	; save registers
-			  ;----store scheduling timer state----
-			  LDR R1, =CTRL
-			  LDR R0, [R1]
-			  PUSH {R0}
-
-				;---clear the interrupt flag----
-				LDR  R4, =TFLG
-				MOVS R1, #1	
-				STR  R1, [R4]
-			  ;-------------------------------
-				
-				;move sp to r0 to prepare for process_select 
-				MOV R0, SP 
-				
-do_process_select
-				;******* Load Original Stack Pointer ********
-				; We want the process select function to run on the "main" stack
-				; This helps reduce funkiness when a process stack is too small and process_select overwrites other memory
-				LDR R1, =OrigStackPointer
-				LDR SP, [R1]
-				;********************************************
-				BL process_select	;Process_select returns 0 if there are no processes left
-				CMP R0, #0
-				BNE resume_process	;take branch if there are more processes
-				
-				; Disable scheduling timer before returning to initial caller
-				LDR R1, =CTRL
-				MOVS R0, #0
-				STR R0, [R1]
-				
-				POP {R4-R11,PC} ; Restore calle-save state and return
-				
-resume_process 
-				MOV SP, R0    ;switch stacks
-				;---- restore scheduling timer state
-				POP {R0}
-			    LDR R1, =CTRL
-			    STR R0, [R1]
-				
-				CPSIE I ; Enable global interrupts before returning from handler
-				POP {R4-R11,PC} ; Restore registers that aren't saved by interrupt, and return from interrupt
-				END
+		AREA myData, DATA, READWRITE
+;global variable in assembly
+SwitchDrop DCD 0x00 ; set by SVC1: the running process has terminated, PendSV_Handler does not save its context
+
+		AREA myProg, CODE, READONLY
+;export assembly functions
+		EXPORT process_terminated
+		EXPORT process_begin
+		EXPORT process_blocked
+		EXPORT PIT0_IRQHandler
+		EXPORT SVC_Handler
+		EXPORT PendSV_Handler
+;import C functions
+		IMPORT process_select
+		IMPORT process_resched
+		IF :DEF:RT_INSTRUMENT
+		IMPORT instr_switch_entry
+		IMPORT instr_switch_done
+		ENDIF
+
+		PRESERVE8
+
+
+TFLG     EQU 0x4003710C ; TFLG address
+CTRL     EQU 0x40037108 ; Ctrl address
+SHCSR    EQU 0xE000ED20
+ICSR     EQU 0xE000ED04 ; Interrupt control and state register
+PENDSVSET EQU 0x10000000 ; ICSR bit that pends PendSV
+CYCCNT   EQU 0xE0001004 ; DWT cycle counter (RT_INSTRUMENT)
+
+;Stores the cycle count in instr_switch_entry (clobbers R0, R1)
+		MACRO
+		INSTR_SWITCH_ENTRY
+		IF :DEF:RT_INSTRUMENT
+		LDR R1, =CYCCNT
+		LDR R0, [R1]
+		LDR R1, =instr_switch_entry
+		STR R0, [R1]
+		ENDIF
+		MEND
+
+;Pends PendSV, which switches processes once no other handler is running (clobbers R0, R1)
+		MACRO
+		PEND_SWITCH
+		LDR R1, =ICSR
+		LDR R0, =PENDSVSET
+		STR R0, [R1]
+		MEND
+
+;Processes run in thread mode on the process stack (PSP). Handlers, and
+;process_select with them, run on the main stack (MSP), so the stack of a
+;process only has to hold its own frames and one exception frame. The
+;scheduler only ever switches in PendSV_Handler, which has the lowest
+;priority: PIT0, the SVCs and port_pend_resched only pend it, and it runs
+;once every other handler has returned.
+
+SVC_Handler
+	TST  LR, #0x4 ; EXC_RETURN bit 2: the caller ran on PSP (a process) or MSP (process_begin)
+	ITE  EQ
+	MRSEQ R1, MSP
+	MRSNE R1, PSP
+	LDR  R1, [R1,#24] ; Read PC of SVC instruction
+	LDRB R0, [R1,#-2] ; Get #N from SVC instruction
+	ADR  R1, SVC_Table
+	LDR  PC, [R1,R0,LSL #2] ; Branch to Nth SVC routine
+
+SVC_Table
+	DCD SVC0_begin
+	DCD SVC1_terminate
+	DCD SVC2_blocked
+
+SVC0_begin
+				CPSID i ; process_select runs with interrupts disabled (PIT1 releases processes)
+				INSTR_SWITCH_ENTRY
+				;---save the caller on the main stack, PendSV_Handler returns to it once process_select returns 0
+				TST LR, #0x10 ; EXC_RETURN bit 4 clear: the caller has used the FPU
+				IT EQ
+				VPUSHEQ {S16-S31}
+				PUSH {R4-R11,LR}
+				;---start the scheduling timer
+				LDR R1, =CTRL
+				MOVS R0, #3 ; Enable scheduling timer and interrupt
+				STR R0, [R1]
+				MOVS R0, #0
+				B do_process_select
+
+SVC1_terminate
+				LDR R1, =SwitchDrop
+				MOVS R0, #1
+				STR R0, [R1]
+SVC2_blocked
+				PEND_SWITCH
+				BX LR ; PendSV_Handler runs right after this returns
+
+process_terminated
+				CPSIE i ; Enable global interrupts, just in case
+				SVC #1 ; SVC1 = process terminated
+				; This SVC shouldn't ever return, as it would mean the process was scheduled again
+
+process_begin
+				CPSIE i ; Enable global interrupts (for SVC)
+				SVC #0 ; Syscall into scheduler
+				BX LR
+
+
+process_blocked
+				CPSIE i ; Enable global interrupts, just in case
+				SVC #2 ; SVC2 = process blocked
+				BX LR
+
+PIT0_IRQHandler ; Timer Interrupt
+			  ;---clear the interrupt flag----
+			  LDR  R1, =TFLG
+			  MOVS R0, #1
+			  STR  R0, [R1]
+			  ;---if nothing was released and no time slicing is needed, the running process simply carries on
+			  LDR  R1, =process_resched
+			  LDR  R0, [R1]
+			  CMP  R0, #0
+			  BEQ  PIT0_done
+			  PEND_SWITCH
+PIT0_done
+			  BX   LR
+			  ;-------------------------------
+
+PendSV_Handler
+				TST LR, #0x4 ; EXC_RETURN bit 2 clear: no process is running (before process_begin, or after it returned)
+				IT EQ
+				BXEQ LR
+				CPSID i 			; Disable all interrupts
+				INSTR_SWITCH_ENTRY
+				LDR R1, =SwitchDrop
+				LDR R0, [R1]
+				CMP R0, #0
+				BEQ save_context
+				;---the process has terminated, its context is dropped
+				MOVS R0, #0
+				STR R0, [R1]
+				TST LR, #0x10
+				IT EQ
+				VMRSEQ R1, FPSCR ; Settles a pending lazy FPU save while the stack is still allocated
+				B do_process_select
+
+save_context
+				MRS R0, PSP
+				TST LR, #0x10 ; EXC_RETURN bit 4 clear: the process has used the FPU, its frame has room for S0-S15 and FPSCR
+				IT EQ
+				VSTMDBEQ R0!, {S16-S31} ; The first FPU instruction also makes the core fill in that room (lazy stacking)
+				STMDB R0!, {R4-R11,LR} ; save registers, with EXC_RETURN to tell the frame apart when restoring
+
+do_process_select
+				; process_select runs on the main stack like every handler
+				; This helps reduce funkiness when a process stack is too small and process_select overwrites other memory
+				BL process_select	;Process_select returns 0 if there are no processes left
+				CMP R0, #0
+				BNE resume_process	;take branch if there are more processes
+
+				; Disable scheduling timer before returning to initial caller
+				LDR R1, =CTRL
+				MOVS R0, #0
+				STR R0, [R1]
+
+				POP {R4-R11,LR} ; Restore the callee-save state SVC0_begin saved
+				TST LR, #0x10
+				IT EQ
+				VPOPEQ {S16-S31}
+				CPSIE I
+				BX LR ; and return from its SVC to process_begin
+
+resume_process
+				IF :DEF:RT_INSTRUMENT
+				MOV R4, R0
+				BL instr_switch_done ; Records the switch
+				MOV R0, R4
+				ENDIF
+
+				LDMIA R0!, {R4-R11,LR} ; Restore registers that aren't saved by interrupt
+				TST LR, #0x10
+				IT EQ
+				VLDMIAEQ R0!, {S16-S31}
+				MSR PSP, R0    ;switch stacks
+				CPSIE I ; Enable global interrupts before returning from handler
+				BX LR ; return from interrupt, the core restores the rest (and S0-S15 if the process uses the FPU)
+				END
@@ -1,97 +1,234 @@
-/*************************************************************************
- *
- *  Copyright (c) 2015 Cornell University
- *  Computer Systems Laboratory
- *  Cornell University, Ithaca, NY 14853
- *  All Rights Reserved
- *
- *  $Id$
- *
- **************************************************************************
- */
-#include "3140_concur.h"
-#include <stdlib.h>
-
-/*
-  State layout:
-
-  .-----------------.
-  |     xPSR   	    | <--- status register
-  |-----------------|
-  |      PC         | <--- starting point of the process's function    
-  |-----------------|
-  |      LR         | <--- process_terminated
-  |-----------------|
-  |      R12        |
-  |-----------------|
-  |    R3 - R0      |
-	|-----------------|
-  |   0xFFFFFFF9    | <--- exception return value 
-  |-----------------|
-  |    R4 - R11     |
-  |-----------------|
-  |    PIT State    |
-  |-----------------|
-
-
-  State requires 18 slots on the stack.
-
- */
-
-
-/*------------------------------------------------------------------------
- *
- *  process_stack_init --
- *
- *   Allocate and initialize a stack for a process
- *
- *------------------------------------------------------------------------
- */
-
-unsigned int * process_stack_init (void (*f)(void), int n)
-{
-  unsigned int *sp;	/* Pointer to process stack (allocated in heap) */ 
-	
-	int i;
-
-	/* in reality, there are 18 more slots needed for stored context */
-	n += 18;
-		
-  /* Allocate space for the process's stack */
-  sp = malloc(n*sizeof(int));
-		 
-  if (sp == NULL) { return NULL; }	/* Allocation failed */
-  
-  /* Initialize the stack to all zeros */ 
-  /* Note: Could just use calloc instead */ 
-  for (i=0; i < n; i++) {
-  	sp[i] = 0;
-  }
-  
-	sp[n-1] = 0x01000000; // xPSR
-  sp[n-2] = (unsigned int) f; // PC
-	sp[n-3] = (unsigned int) process_terminated; // LR
-	sp[n-9] = 0xFFFFFFF9; // EXC_RETURN value, returns to thread mode
-	sp[n-18] = 0x3; // Enable scheduling timer and interrupt
-  
-  return &(sp[n-18]);
-}
-
-/*------------------------------------------------------------------------
- *
- *  process_stack_free --
- *
- *   Free a process stack allocated by process_stack_init. Call this with the SP
- * which was returned by process_stack_init, and the stack size which was passed
- * to process_stack_init
- *
- *------------------------------------------------------------------------
- */
-void process_stack_free(unsigned int *sp, int n)
-{
-	// process_init returned a pointer to the top of the stack, which is near
-	// the end of the allocated region. We need to recover the pointer returned
-	// by malloc
-	unsigned int *stack_base = sp - n;
-	free(stack_base);
-}
+/*************************************************************************
+ *
+ *  Copyright (c) 2015 Cornell University
+ *  Computer Systems Laboratory
+ *  Cornell University, Ithaca, NY 14853
+ *  All Rights Reserved
+ *
+ *  $Id$
+ *
+ **************************************************************************
+ */
+#include "3140_concur.h"
+#include <stdlib.h>
+#include "pool.h"
+
+/*
+  State layout:
+
+  .-----------------.
+  |     xPSR   	    | <--- status register
+  |-----------------|
+  |      PC         | <--- starting point of the process's function    
+  |-----------------|
+  |      LR         | <--- process_terminated
+  |-----------------|
+  |      R12        |
+  |-----------------|
+  |    R3 - R0      |
+	|-----------------|
+  |   0xFFFFFFFD    | <--- exception return value 
+  |-----------------|
+  |    R4 - R11     |
+  |-----------------|
+
+
+  State requires PROCESS_CONTEXT_WORDS (17) slots on the stack. The
+  exception return value makes PendSV_Handler return to thread mode on
+  the process stack (PSP). Once the process has used the FPU, the core
+  stacks an extended frame (S0-S15 and FPSCR above R0-R3 and the rest),
+  the exception return value changes to 0xFFFFFFED and PendSV_Handler
+  saves S16-S31 between it and R4 - R11.
+
+  The rest of the block is painted with PROCESS_STACK_PAINT, except for
+  its lowest word, which holds PROCESS_STACK_GUARD. The highest painted
+  word that has been overwritten shows how deep the stack has ever been,
+  and an overwritten guard word shows that it ran past the bottom.
+
+ */
+
+
+/*------------------------------------------------------------------------
+ *
+ *  process_stack_init --
+ *
+ *   Allocate and initialize a stack for a process
+ *
+ *------------------------------------------------------------------------
+ */
+
+unsigned int * process_stack_init (void (*f)(void), int n)
+{
+  unsigned int *sp = NULL;	/* Pointer to process stack (allocated from a stack pool) */ 
+	
+	int i;
+
+	/* in reality, there are more slots needed for stored context, and one for the guard word */
+	n += PROCESS_CONTEXT_WORDS + 1;
+		
+  /* Take a stack from the smallest size class that fits, or a larger one if it is used up */
+  for (i = 0; (i < RT_STACK_CLASSES) && (sp == NULL); i++) {
+  	if (process_stack_pools[i].block_size >= (unsigned int) n*sizeof(int)) {
+  		sp = pool_alloc(&process_stack_pools[i]);
+  	}
+  }
+		 
+  if (sp == NULL) { return NULL; }	/* Allocation failed */
+
+  /* The whole block is usable, the context goes at its top */
+  n = process_stack_pools[i-1].block_size / sizeof(int);
+  
+  /* Paint the stack and zero the saved context */
+  sp[0] = PROCESS_STACK_GUARD;
+  for (i=1; i < n-PROCESS_CONTEXT_WORDS; i++) {
+  	sp[i] = PROCESS_STACK_PAINT;
+  }
+  for (i=n-PROCESS_CONTEXT_WORDS; i < n; i++) {
+  	sp[i] = 0;
+  }
+  
+  return process_stack_reset(&(sp[n-PROCESS_CONTEXT_WORDS]), f);
+}
+
+/*------------------------------------------------------------------------
+ *
+ *  process_stack_free --
+ *
+ *   Free a process stack allocated by process_stack_init. Call this with the SP
+ * which was returned by process_stack_init, and the stack size which was passed
+ * to process_stack_init
+ *
+ *------------------------------------------------------------------------
+ */
+void process_stack_free(unsigned int *sp, int n)
+{
+	// process_init returned a pointer to the top of the stack, which is near
+	// the end of the block. The block is found from the address, so this works
+	// whichever size class the stack came from
+	int i;
+	(void) n;
+	for (i = 0; i < RT_STACK_CLASSES; i++) {
+		void *stack_base = pool_block_of(&process_stack_pools[i], sp);
+		if (stack_base != NULL) {
+			pool_free(&process_stack_pools[i], stack_base);
+			return;
+		}
+	}
+}
+
+/*------------------------------------------------------------------------
+ *
+ *  process_stack_reset --
+ *
+ *   Reset a stack returned by process_stack_init to its initial state, so
+ * that the process starts again from the beginning of f. Returns the stack
+ * pointer to resume the process with
+ *
+ *------------------------------------------------------------------------
+ */
+unsigned int * process_stack_reset(unsigned int *sp, void (*f)(void))
+{
+	sp[16] = 0x01000000; // xPSR
+	sp[15] = (unsigned int) f; // PC
+	sp[14] = (unsigned int) process_terminated; // LR
+	sp[8] = 0xFFFFFFFD; // EXC_RETURN value, returns to thread mode on PSP without FPU state
+	return sp;
+}
+
+/*------------------------------------------------------------------------
+ *
+ *  process_stack_block --
+ *
+ *   Find the stack block that sp points into, and its size in words.
+ * Returns NULL if sp is not in any stack pool
+ *
+ *------------------------------------------------------------------------
+ */
+static unsigned int * process_stack_block(unsigned int *sp, unsigned int *words)
+{
+	int i;
+	for (i = 0; i < RT_STACK_CLASSES; i++) {
+		unsigned int *block = pool_block_of(&process_stack_pools[i], sp);
+		if (block != NULL) {
+			*words = process_stack_pools[i].block_size / sizeof(int);
+			return block;
+		}
+	}
+	return NULL;
+}
+
+/*------------------------------------------------------------------------
+ *
+ *  process_stack_frame --
+ *
+ *   Start a job of f on a stack that several jobs share, right below top,
+ * or at the top of the stack that sp points into if top is NULL. Only the
+ * words the first switch to the job reads are written. Returns the stack
+ * pointer to start the job with
+ *
+ *------------------------------------------------------------------------
+ */
+unsigned int * process_stack_frame(unsigned int *sp, unsigned int *top, void (*f)(void))
+{
+	unsigned int words;
+	if (top == NULL) {
+		top = process_stack_block(sp, &words) + words;
+	}
+	return process_stack_reset(top - PROCESS_CONTEXT_WORDS, f);
+}
+
+/*------------------------------------------------------------------------
+ *
+ *  process_stack_fits --
+ *
+ *   Return whether a frame right below top (or at the top if top is NULL)
+ * in the stack that sp points into leaves n words for the job above the
+ * guard word
+ *
+ *------------------------------------------------------------------------
+ */
+int process_stack_fits(unsigned int *sp, unsigned int *top, int n)
+{
+	unsigned int words;
+	unsigned int *block = process_stack_block(sp, &words);
+	if (block == NULL) { return 0; }
+	if (top == NULL) {
+		top = block + words;
+	}
+	return top - block > PROCESS_CONTEXT_WORDS + n; /* block[0] is the guard word */
+}
+
+/*------------------------------------------------------------------------
+ *
+ *  process_stack_used --
+ *
+ *   Return how many words of the stack that sp points into have ever been
+ * used, not counting the slots of the saved context
+ *
+ *------------------------------------------------------------------------
+ */
+unsigned int process_stack_used(unsigned int *sp)
+{
+	unsigned int words, i;
+	unsigned int *block = process_stack_block(sp, &words);
+	if (block == NULL) { return 0; }
+	for (i = 1; (i < words) && (block[i] == PROCESS_STACK_PAINT); i++) {
+	}
+	return (words - i > PROCESS_CONTEXT_WORDS) ? words - i - PROCESS_CONTEXT_WORDS : 0;
+}
+
+/*------------------------------------------------------------------------
+ *
+ *  process_stack_intact --
+ *
+ *   Return whether the guard word at the bottom of the stack that sp
+ * points into is still in place
+ *
+ *------------------------------------------------------------------------
+ */
+int process_stack_intact(unsigned int *sp)
+{
+	unsigned int words;
+	unsigned int *block = process_stack_block(sp, &words);
+	return (block != NULL) && (block[0] == PROCESS_STACK_GUARD);
+}
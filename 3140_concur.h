@@ -1,116 +1,229 @@
-/*************************************************************************
- *
- *  Copyright (c) 2015 Cornell University
- *  Computer Systems Laboratory
- *  Cornell University, Ithaca, NY 14853
- *  All Rights Reserved
- *
- *  $Id$
- *
- **************************************************************************
- */
-#ifndef __3140_CONCUR_H__
-#define __3140_CONCUR_H__
-
-#include <stdlib.h>
-#include <MK64F12.h>
-
-struct process_state;
-typedef struct process_state process_t;
-   /* opaque definition of process type; you must provide this
-      implementation.
-			
-			To do this, write code similar to the following in your process.c:
-			
-			struct process_state {
-				int var1;
-				struct process_state* some_pointer;
-			};
-   */
-
-/*------------------------------------------------------------------------
-
-   THE FOLLOWING FUNCTIONS MUST BE CREATED IN process.c.
-
-------------------------------------------------------------------------*/
-
-/* ====== Concurrency ====== */
-
-/* Called by the runtime system to select another process.
-   "cursp" = the stack pointer for the currently running process
-	 cursp will be NULL when first starting the scheduler, and when a process terminates
-	 Return the stack pointer for the new process to run, or NULL to exit the scheduler.
-*/
-extern unsigned int * process_select (unsigned int * cursp);
-
-/* the currently running process. current_process must be NULL if no process is running,
-    otherwise it must point to the process_t of the currently running process
-*/
-extern process_t * current_process; 
-extern process_t * process_queue;
-
-/* Starts up the concurrent execution */
-void process_start (void);
-
-/* Create a new process. Return -1 if creation failed */
-int process_create (void (*f)(void), int n);
-
-
-/*------------------------------------------------------------------------
-  
-You may use the following functions that we have provided
-
-------------------------------------------------------------------------*/
-
-
-/* This function can ONLY BE CALLED if interrupts are disabled.
-   This function switches execution to the next ready process, and is
-   also the entry point for the timer interrupt.
-   
-   Implemented in 3140.s
-*/
-extern void process_blocked (void);
-
-/*
-  This function is called by user code indirectly when the process
-  terminates. This is handled by stack manipulation.
-	
-	You should not need to call this function yourself.
-
-  Implemented in 3140.s
-  Used in 3140_concur.c
-*/
-extern void process_terminated (void);
-
-/* This function can ONLY BE CALLED if interrupts are disabled. It
-   does not modify interrupt flags.
-	 
-	 Allocates a stack for a process, and sets up the stack's initial state
-	 
-	 Implemented in 3140_concur.c
-*/
-unsigned int * process_stack_init (void (*f)(void), int n);
-
-/* This function can ONLY BE CALLED if interrupts are disabled. It
-   does not modify interrupt flags.
-	 
-	 Frees a stack allocated in process_init. Must be called with the same value
-	 of n as process_init
-	 
-	 Implemented in 3140_concur.c
-*/
-void process_stack_free (unsigned int *sp, int n);
-
-/*
-  This function starts the concurrency by using the timer interrupt
-  context switch routine to call the first ready process.
-
-  The function also gracefully exits once the process_select()
-  function returns 0.
-	
-	Implemented in 3140.s
-*/
-extern void process_begin (void);
-
-
-#endif
+/*************************************************************************
+ *
+ *  Copyright (c) 2015 Cornell University
+ *  Computer Systems Laboratory
+ *  Cornell University, Ithaca, NY 14853
+ *  All Rights Reserved
+ *
+ *  $Id$
+ *
+ **************************************************************************
+ */
+#ifndef __3140_CONCUR_H__
+#define __3140_CONCUR_H__
+
+#include <stdlib.h>
+#include "rtconfig.h"
+#ifndef RT_HOST
+#include <MK64F12.h>
+#endif
+
+struct process_state;
+typedef struct process_state process_t;
+   /* opaque definition of process type; you must provide this
+      implementation.
+			
+			To do this, write code similar to the following in your process.c:
+			
+			struct process_state {
+				int var1;
+				struct process_state* some_pointer;
+			};
+   */
+
+/*------------------------------------------------------------------------
+
+   THE FOLLOWING FUNCTIONS MUST BE CREATED IN process.c.
+
+------------------------------------------------------------------------*/
+
+/* ====== Concurrency ====== */
+
+/* Called by the runtime system to select another process.
+   "cursp" = the stack pointer for the currently running process
+	 cursp will be NULL when first starting the scheduler, and when a process terminates
+	 Return the stack pointer for the new process to run, or NULL to exit the scheduler.
+*/
+extern unsigned int * process_select (unsigned int * cursp);
+
+/* the currently running process. current_process must be NULL if no process is running,
+    otherwise it must point to the process_t of the currently running process
+*/
+extern RT_PERCORE process_t * current_process; 
+extern RT_PERCORE process_t * process_queue;
+
+/* set when the next PIT0 tick has to call process_select (a release may
+   preempt the running process, or time slicing is needed); otherwise the
+   PIT0 handler in 3140.s returns straight to the running process instead
+   of pending PendSV */
+extern RT_PERCORE volatile int process_resched;
+
+/* Starts up the concurrent execution */
+void process_start (void);
+
+/* Stops the concurrent execution: process_start returns at the next
+   scheduling point (the next timer interrupt, or right away if the caller
+   blocks) and every remaining process is discarded */
+void process_stop (void);
+
+#ifdef RT_MULTICORE
+/* Sets up the scheduler of the simulated core the calling thread runs
+   (multicore.h), before the first process of the thread is created */
+void process_core_init (void);
+#endif
+
+/* Create a new process. Return -1 if creation failed */
+int process_create (void (*f)(void), int n);
+
+/* Return the id of the calling process. Processes are numbered from 1 in
+   the order they are created, starting over once process_start returns
+   (these are the task numbers of the RT_TRACE trace, see trace.h) */
+unsigned int process_id (void);
+
+/* Usage of one of the static memory pools that processes are created from */
+typedef struct {
+	unsigned int block_size; /* bytes per block */
+	unsigned int total; /* the number of blocks in the pool */
+	unsigned int used; /* the number of blocks in use */
+	unsigned int high_water; /* the most blocks that have been in use at once */
+} pool_stats_t;
+
+/* Get the usage of pool 0 (process structs) or pools 1 to RT_STACK_CLASSES
+   (stacks, smallest size class first). Return -1 if there is no such pool */
+int process_pool_stats (int pool, pool_stats_t * stats);
+
+/* Return the most stack the calling process has used so far, in words (the
+   n of process_create, so the saved context is not counted). For a basic
+   task this is the most the shared stack has held at once */
+unsigned int process_stack_high_water (void);
+
+/* Get the most stack any process running f has used since the last
+   process_rt_stats_reset, in words: the smallest n that f ran with safely
+   (only kept when built with RT_STACK_PROFILE, see rtconfig.h). Leave a
+   margin for paths the run did not take. Return -1 if nothing is known
+   about f */
+int process_stack_profile (void (*f)(void), unsigned int * n);
+
+/* the number of processes that were stopped because they ran past the
+   bottom of their stack (checked at every switch with RT_STACK_CHECK) */
+extern RT_PERCORE int process_stack_overflows;
+
+
+/*------------------------------------------------------------------------
+  
+You may use the following functions that we have provided
+
+------------------------------------------------------------------------*/
+
+
+/* This function can ONLY BE CALLED if interrupts are disabled.
+   This function switches execution to the next ready process: it pends
+   PendSV, which does every switch (the timer interrupt pends it too).
+   
+   Implemented in 3140.s
+*/
+extern void process_blocked (void);
+
+/*
+  This function is called by user code indirectly when the process
+  terminates. This is handled by stack manipulation.
+	
+	You should not need to call this function yourself.
+
+  Implemented in 3140.s
+  Used in 3140_concur.c
+*/
+extern void process_terminated (void);
+
+/* This function can ONLY BE CALLED if interrupts are disabled. It
+   does not modify interrupt flags.
+	 
+	 Allocates a stack for a process, and sets up the stack's initial state
+	 
+	 Implemented in 3140_concur.c
+*/
+unsigned int * process_stack_init (void (*f)(void), int n);
+
+/* This function can ONLY BE CALLED if interrupts are disabled. It
+   does not modify interrupt flags.
+	 
+	 Frees a stack allocated in process_init. Must be called with the same value
+	 of n as process_init
+	 
+	 Implemented in 3140_concur.c
+*/
+void process_stack_free (unsigned int *sp, int n);
+
+/* This function can ONLY BE CALLED if interrupts are disabled. It
+   does not modify interrupt flags.
+	 
+	 Resets a stack allocated in process_init (sp is the value process_init
+	 returned) so that the process starts over from the beginning of f.
+	 Returns the stack pointer to resume the process with
+	 
+	 Implemented in 3140_concur.c
+*/
+unsigned int * process_stack_reset (unsigned int *sp, void (*f)(void));
+
+/* This function can ONLY BE CALLED if interrupts are disabled. It
+   does not modify interrupt flags.
+	 
+	 Sets up a job of f on the stack that sp (from process_init) points
+	 into, which basic tasks share: its frame goes right below top (the
+	 stack pointer of the job it starts on top of), or at the top of the
+	 stack if top is NULL. Returns the stack pointer to start the job with
+	 
+	 Implemented in 3140_concur.c
+*/
+unsigned int * process_stack_frame (unsigned int *sp, unsigned int *top, void (*f)(void));
+
+/* This function can ONLY BE CALLED if interrupts are disabled. It
+   does not modify interrupt flags.
+	 
+	 Returns whether a frame that process_stack_frame would set up below
+	 top (or at the top of the stack if top is NULL) in the stack that sp
+	 points into leaves n words of stack for the job above the guard word
+	 
+	 Implemented in 3140_concur.c
+*/
+int process_stack_fits (unsigned int *sp, unsigned int *top, int n);
+
+/* Stacks are painted with PROCESS_STACK_PAINT when they are allocated, and
+   the lowest word of a stack holds PROCESS_STACK_GUARD */
+#define PROCESS_STACK_PAINT 0xCCCCCCCC
+#define PROCESS_STACK_GUARD 0xDEADBEEF
+
+/* The words of stack the saved context of a process takes. A process that
+   has used the FPU saves 34 more words with it (S0-S31, FPSCR and a
+   reserved word), so give it that much more stack */
+#define PROCESS_CONTEXT_WORDS 17
+
+/* Returns how many words of the stack that sp (any pointer into a stack
+   from process_stack_init) points into have ever been used, not counting
+   the saved context: the high-water mark found from the paint.
+	 
+	 Implemented in 3140_concur.c
+*/
+unsigned int process_stack_used (unsigned int *sp);
+
+/* Returns whether the guard word at the bottom of the stack that sp points
+   into is still in place. If it is not, the process has run past the
+   bottom of its stack and may have overwritten the memory below it.
+	 
+	 Implemented in 3140_concur.c
+*/
+int process_stack_intact (unsigned int *sp);
+
+/*
+  This function starts the concurrency by using the timer interrupt
+  context switch routine to call the first ready process.
+
+  The function also gracefully exits once the process_select()
+  function returns 0.
+	
+	Implemented in 3140.s
+*/
+extern void process_begin (void);
+
+
+#endif
@@ -0,0 +1,535 @@
+/*************************************************************************
+ *
+ *  Host simulation backend for the scheduler (build with -DRT_HOST).
+ *
+ *  Implements the functions that 3140_concur.c, 3140.s and port_k64f.c
+ *  provide on the board, on top of ucontext and a simulated clock. See
+ *  host.h for how a scenario is built and driven.
+ *
+ **************************************************************************
+ */
+#include <stdlib.h>
+#include <time.h>
+#include <ucontext.h>
+#include "3140_concur.h"
+#include "port.h"
+#include "pool.h"
+#include "host.h"
+#include "instr.h"
+
+/*
+  process.c still gets its stacks from the same size class pools as on the
+  board, so pool exhaustion and high-water marks behave the same. The pool
+  block only stands in for the stack though: each block has a real host
+  stack and ucontext behind it, made the first time the block is used and
+  kept for reuse. The "stack pointer" process.c sees is the block address.
+
+  The block is painted like a board stack, with the top
+  PROCESS_CONTEXT_WORDS words taken by the saved context, so stack checks and profiles see the stack use that
+  processes simulate with host_stack_use.
+
+  The jobs of basic tasks share one block (process_stack_frame). Each job
+  that has a frame in it gets a host stack of its own, by how many jobs are
+  nested below the top of the block, and the stack pointer process.c sees
+  is its frame in the block. When the job is switched out it reports the
+  lowest word it has used with host_stack_use, so the next job starts
+  below that, like on the board.
+ */
+
+typedef struct {
+	ucontext_t context; /* the saved host context of the process */
+	void (* f)(void); /* the function the process starts in */
+	char stack[HOST_STACK_BYTES]; /* the host stack */
+} host_stack_t;
+
+static RT_PERCORE host_stack_t ** host_stacks[RT_STACK_CLASSES]; /* the host stack behind each pool block */
+
+/* A job frame in the shared block (process_stack_frame) */
+typedef struct {
+	unsigned int * block; /* the block the frame is in */
+	unsigned int * top; /* the word above the frame */
+	unsigned int * sp; /* the stack pointer the job started with, its context above it */
+	unsigned int * low; /* the lowest word the job has used */
+	host_stack_t * stack; /* the host stack of the job */
+} host_frame_t;
+
+#define HOST_FRAMES (2 * RT_MAX_PROCESSES) /* a job per process, and the gaps left by dropped ones */
+
+static RT_PERCORE host_frame_t host_frames[HOST_FRAMES]; /* the frames in the shared block, from the top down */
+
+static RT_PERCORE int host_frame_count = 0; /* the frames in host_frames, the ones of finished jobs included until a new frame takes their place */
+
+static RT_PERCORE ucontext_t host_scheduler; /* the context of process_begin, where process_select runs */
+
+static RT_PERCORE host_stack_t * host_running = NULL; /* the host stack of the running process */
+
+static RT_PERCORE unsigned int * host_running_sp = NULL; /* the stack pointer process.c knows the running process by */
+
+static RT_PERCORE unsigned int * host_trap_sp = NULL; /* what the running process passes to process_select when it traps */
+
+static RT_PERCORE tick_t host_now = 0; /* the simulated time */
+
+static RT_PERCORE tick_t host_stop = 0; /* the time to call process_stop at (0 = never) */
+
+static RT_PERCORE int host_stopped = 0; /* whether process_stop has been called for host_stop */
+
+#ifdef RT_TICKLESS
+
+static RT_PERCORE tick_t host_wakeup = 0; /* the time of the armed tickless wakeup */
+
+#endif
+
+static RT_PERCORE int host_wakeup_armed = 0; /* whether a tickless wakeup is armed */
+
+static RT_PERCORE int host_pended = 0; /* whether port_pend_resched has pended a switch */
+
+RT_PERCORE host_stats_t host_stats;
+
+typedef struct {
+	tick_t when; /* the tick it fires at */
+	void (* handler)(void); /* the handler, NULL for a free entry */
+} host_interrupt_t;
+
+static RT_PERCORE host_interrupt_t host_interrupts[HOST_INTERRUPTS]; /* the simulated device interrupts still to fire */
+
+/* Returns the frame in the shared block that sp points into, NULL if it is not in one */
+
+static host_frame_t * host_frame_of(unsigned int * sp) {
+	int i;
+	for (i = host_frame_count - 1; i >= 0; i--) { //The lowest frame whose top is above sp
+		if ((sp >= host_frames[i].block) && (sp < host_frames[i].top)) {
+			return &host_frames[i];
+		}
+	}
+	return NULL;
+}
+
+/* Returns the host stack behind a stack pointer from process_stack_init or process_stack_frame */
+
+static host_stack_t * host_stack_of(unsigned int * sp) {
+	int i;
+	host_frame_t * frame = host_frame_of(sp);
+	if (frame != NULL) {
+		return frame->stack;
+	}
+	for (i = 0; i < RT_STACK_CLASSES; i++) {
+		pool_t * pool = &process_stack_pools[i];
+		unsigned char * block = pool_block_of(pool, sp);
+		if (block != NULL) {
+			unsigned int index = (block - pool->memory) / pool->block_size;
+			if (host_stacks[i] == NULL) {
+				host_stacks[i] = calloc(pool->count, sizeof(host_stack_t *));
+			}
+			if (host_stacks[i][index] == NULL) {
+				host_stacks[i][index] = malloc(sizeof(host_stack_t));
+			}
+			return host_stacks[i][index];
+		}
+	}
+	abort(); //Not a stack from process_stack_init
+}
+
+/* Returns the stack pool block that sp points into and its size in words, NULL if there is none */
+
+static unsigned int * host_stack_block(unsigned int * sp, unsigned int * words) {
+	int i;
+	for (i = 0; i < RT_STACK_CLASSES; i++) {
+		unsigned int * block = pool_block_of(&process_stack_pools[i], sp);
+		if (block != NULL) {
+			*words = process_stack_pools[i].block_size / sizeof(int);
+			return block;
+		}
+	}
+	return NULL;
+}
+
+/* Every process starts here, runs its function and then terminates */
+
+static void host_entry(void) {
+	host_running->f();
+	process_terminated();
+}
+
+/* Calls process_select and keeps the statistics */
+
+static unsigned int * host_select(unsigned int * cursp) {
+	struct timespec t0, t1;
+	unsigned int * sp;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	sp = process_select(cursp);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	host_stats.selects += 1;
+	host_stats.select_ns += (t1.tv_sec - t0.tv_sec) * 1000000000ULL + t1.tv_nsec - t0.tv_nsec;
+	if ((sp != NULL) && (sp != cursp)) {
+		host_stats.switches += 1;
+	}
+	return sp;
+}
+
+#ifdef RT_TICKLESS
+
+/* Returns the time of the next simulated device interrupt (0 = none) */
+
+static tick_t host_next_interrupt(void) {
+	tick_t next = 0;
+	int i;
+	for (i = 0; i < HOST_INTERRUPTS; i++) {
+		if ((host_interrupts[i].handler != NULL) && ((next == 0) || (host_interrupts[i].when < next))) {
+			next = host_interrupts[i].when;
+		}
+	}
+	return next;
+}
+
+#endif
+
+/* One simulated tick: the device interrupts that are due, then the PIT1 interrupt path */
+
+static void host_tick(void) {
+	int i;
+	host_now += 1;
+	for (i = 0; i < HOST_INTERRUPTS; i++) {
+		if ((host_interrupts[i].handler != NULL) && (host_interrupts[i].when <= host_now)) {
+			void (* handler)(void) = host_interrupts[i].handler;
+			host_interrupts[i].handler = NULL;
+			handler();
+		}
+	}
+#ifdef RT_TICKLESS
+	if (host_wakeup_armed && (host_now >= host_wakeup)) {
+		host_wakeup_armed = 0;
+		process_timer_interrupt();
+	}
+#else
+	process_timer_interrupt();
+#endif
+	if ((host_stop != 0) && (host_now >= host_stop) && !host_stopped) {
+		host_stopped = 1;
+		process_stop();
+	}
+}
+
+/*------------------------------------------------------------------------
+ *  3140_concur.c
+ *------------------------------------------------------------------------
+ */
+
+unsigned int * process_stack_init(void (*f)(void), int n)
+{
+	unsigned int *sp = NULL;
+	unsigned int i, words;
+	n += PROCESS_CONTEXT_WORDS + 1;
+	for (i = 0; (i < RT_STACK_CLASSES) && (sp == NULL); i++) {
+		if (process_stack_pools[i].block_size >= (unsigned int) n*sizeof(int)) {
+			sp = pool_alloc(&process_stack_pools[i]);
+		}
+	}
+	if (sp == NULL) { return NULL; }
+	words = process_stack_pools[i-1].block_size / sizeof(int);
+	sp[0] = PROCESS_STACK_GUARD;
+	for (i = 1; i < words; i++) {
+		sp[i] = (i < words - PROCESS_CONTEXT_WORDS) ? PROCESS_STACK_PAINT : 0;
+	}
+	return process_stack_reset(sp, f);
+}
+
+void process_stack_free(unsigned int *sp, int n)
+{
+	int i;
+	(void) n;
+	for (i = 0; i < RT_STACK_CLASSES; i++) {
+		void *stack_base = pool_block_of(&process_stack_pools[i], sp);
+		if (stack_base != NULL) {
+			pool_free(&process_stack_pools[i], stack_base);
+			return;
+		}
+	}
+}
+
+unsigned int * process_stack_reset(unsigned int *sp, void (*f)(void))
+{
+	host_stack_t * stack = host_stack_of(sp);
+	getcontext(&stack->context);
+	stack->context.uc_stack.ss_sp = stack->stack;
+	stack->context.uc_stack.ss_size = sizeof(stack->stack);
+	stack->context.uc_link = NULL;
+	makecontext(&stack->context, host_entry, 0);
+	stack->f = f;
+	return sp;
+}
+
+unsigned int * process_stack_frame(unsigned int *sp, unsigned int *top, void (*f)(void))
+{
+	unsigned int words, i;
+	unsigned int * block = host_stack_block(sp, &words);
+	host_frame_t * frame;
+	if (block == NULL) {
+		abort(); //Not a stack from process_stack_init
+	}
+	if (top == NULL) {
+		top = block + words;
+	}
+	while ((host_frame_count > 0) && (host_frames[host_frame_count - 1].top <= top)) { //Jobs that finished, this one takes their place
+		host_frame_count -= 1;
+	}
+	if (host_frame_count == HOST_FRAMES) {
+		abort(); //More than process.c can have
+	}
+	frame = &host_frames[host_frame_count++];
+	if (frame->stack == NULL) {
+		frame->stack = malloc(sizeof(host_stack_t));
+	}
+	frame->block = block;
+	frame->top = top;
+	frame->sp = top - PROCESS_CONTEXT_WORDS;
+	frame->low = frame->sp;
+	for (i = 0; i < PROCESS_CONTEXT_WORDS; i++) { //Where the board keeps the context
+		frame->sp[i] = 0;
+	}
+	getcontext(&frame->stack->context);
+	frame->stack->context.uc_stack.ss_sp = frame->stack->stack;
+	frame->stack->context.uc_stack.ss_size = sizeof(frame->stack->stack);
+	frame->stack->context.uc_link = NULL;
+	makecontext(&frame->stack->context, host_entry, 0);
+	frame->stack->f = f;
+	return frame->sp;
+}
+
+int process_stack_fits(unsigned int *sp, unsigned int *top, int n)
+{
+	unsigned int words;
+	unsigned int * block = host_stack_block(sp, &words);
+	if (block == NULL) { return 0; }
+	if (top == NULL) {
+		top = block + words;
+	}
+	return top - block > PROCESS_CONTEXT_WORDS + n; //block[0] is the guard word
+}
+
+unsigned int process_stack_used(unsigned int *sp)
+{
+	unsigned int words, i;
+	unsigned int * block = host_stack_block(sp, &words);
+	if (block == NULL) { return 0; }
+	for (i = 1; (i < words) && (block[i] == PROCESS_STACK_PAINT); i++) {
+	}
+	return (words - i > PROCESS_CONTEXT_WORDS) ? words - i - PROCESS_CONTEXT_WORDS : 0;
+}
+
+int process_stack_intact(unsigned int *sp)
+{
+	unsigned int words;
+	unsigned int * block = host_stack_block(sp, &words);
+	return (block != NULL) && (block[0] == PROCESS_STACK_GUARD);
+}
+
+/*------------------------------------------------------------------------
+ *  3140.s
+ *------------------------------------------------------------------------
+ */
+
+void process_begin(void)
+{
+	unsigned int * sp = host_select(NULL);
+	while (sp != NULL) {
+		host_running = host_stack_of(sp);
+		host_running_sp = sp;
+#ifdef RT_INSTRUMENT
+		instr_switch_done();
+#endif
+		swapcontext(&host_scheduler, &host_running->context); //Runs the process until it blocks or terminates
+		sp = host_select(host_trap_sp);
+	}
+	host_running = NULL;
+	host_running_sp = NULL;
+}
+
+void process_blocked(void)
+{
+	host_frame_t * frame;
+	if (host_running == NULL) { //Not called from a process
+		return;
+	}
+	frame = host_frame_of(host_running_sp);
+	host_trap_sp = (frame != NULL) ? frame->low : host_running_sp; //A job on the shared stack is switched out with its stack below it
+#ifdef RT_INSTRUMENT
+	instr_switch_entry = instr_clock();
+#endif
+	swapcontext(&host_running->context, &host_scheduler);
+}
+
+void process_terminated(void)
+{
+	host_trap_sp = NULL;
+#ifdef RT_INSTRUMENT
+	instr_switch_entry = instr_clock();
+#endif
+	setcontext(&host_scheduler);
+}
+
+/*------------------------------------------------------------------------
+ *  port_k64f.c
+ *------------------------------------------------------------------------
+ */
+
+void port_timer_start(void)
+{
+	host_now = 0;
+	host_stopped = 0;
+	host_wakeup_armed = 0;
+	host_pended = 0;
+	host_frame_count = 0;
+	host_stats.selects = 0;
+	host_stats.switches = 0;
+	host_stats.select_ns = 0;
+	host_stats.elided = 0;
+}
+
+void port_pend_resched(void)
+{
+	host_pended = 1;
+}
+
+unsigned int port_cycles(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (unsigned int) (now.tv_sec * 1000000000ULL + now.tv_nsec); //Nanoseconds stand in for cycles
+}
+
+unsigned int port_irq_save(void)
+{
+	return 0; //Simulated interrupts only happen inside host_run() and port_idle()
+}
+
+void port_irq_restore(unsigned int state)
+{
+	(void) state;
+}
+
+tick_t port_time_now(void)
+{
+	return host_now;
+}
+
+void port_timer_wakeup(tick_t when)
+{
+#ifdef RT_TICKLESS
+	host_wakeup = when;
+	host_wakeup_armed = 1;
+#else
+	(void) when;
+#endif
+}
+
+void port_idle(void)
+{
+#ifdef RT_TICKLESS
+	//Nothing happens until the wakeup (or the stop time), so the clock jumps straight there
+	tick_t next = host_now + 1;
+	tick_t interrupt = host_next_interrupt();
+	if (host_wakeup_armed && (host_wakeup > next)) {
+		next = host_wakeup;
+	}
+	if ((interrupt != 0) && (interrupt < next)) {
+		next = (interrupt > host_now) ? interrupt : host_now + 1;
+	}
+	if ((host_stop != 0) && !host_stopped && (host_stop > host_now) && (host_stop < next)) {
+		next = host_stop;
+	}
+	host_now = next - 1;
+#endif
+	host_tick();
+}
+
+/*------------------------------------------------------------------------
+ *  Simulation control (host.h)
+ *------------------------------------------------------------------------
+ */
+
+void host_run(unsigned int ticks)
+{
+	while (ticks > 0) {
+		ticks -= 1;
+		host_tick();
+		if ((host_running != NULL) && (((host_now % HOST_SLICE_TICKS) == 0) || host_pended || host_stopped)) { //PIT0 fires, or a switch is pended
+			host_pended = 0;
+			if (process_resched) {
+				process_blocked();
+			}
+			else { //PIT0_IRQHandler does not pend PendSV
+				host_stats.elided += 1;
+			}
+		}
+	}
+}
+
+void host_stack_use(unsigned int words)
+{
+	unsigned int size, i;
+	unsigned int * block;
+	host_frame_t * frame;
+	if (host_running_sp == NULL) {
+		return;
+	}
+	frame = host_frame_of(host_running_sp);
+	if (frame != NULL) { //Down from just below the frame, at most to the guard word of the shared block
+		for (i = 0; (i < words) && (frame->sp - i > frame->block); i++) {
+			frame->sp[-1 - (int) i] = 0;
+		}
+		if (frame->sp - i < frame->low) {
+			frame->low = frame->sp - i;
+		}
+		return;
+	}
+	block = host_stack_block(host_running_sp, &size);
+	if (block == NULL) {
+		return;
+	}
+	for (i = 0; (i < words) && (i < size - PROCESS_CONTEXT_WORDS); i++) { //Down from just below the saved context, at most to the guard word
+		block[size - PROCESS_CONTEXT_WORDS - 1 - i] = 0;
+	}
+}
+
+void host_free_stacks(void)
+{
+	int i;
+	unsigned int j;
+	for (i = 0; i < RT_STACK_CLASSES; i++) {
+		if (host_stacks[i] != NULL) {
+			for (j = 0; j < process_stack_pools[i].count; j++) {
+				free(host_stacks[i][j]);
+			}
+			free(host_stacks[i]);
+			host_stacks[i] = NULL;
+		}
+	}
+	for (i = 0; i < HOST_FRAMES; i++) {
+		free(host_frames[i].stack);
+		host_frames[i].stack = NULL;
+	}
+	host_frame_count = 0;
+}
+
+int host_interrupt_at(tick_t when, void (* handler)(void))
+{
+	int i;
+	for (i = 0; i < HOST_INTERRUPTS; i++) {
+		if (host_interrupts[i].handler == NULL) {
+			host_interrupts[i].when = when;
+			host_interrupts[i].handler = handler;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+void host_stop_at(tick_t when)
+{
+	host_stop = when;
+}
+
+tick_t host_time(void)
+{
+	return host_now;
+}
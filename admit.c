@@ -0,0 +1,264 @@
+#include <stdlib.h>
+#include "admit.h"
+
+/* Returns a / b as 32.32 fixed point, rounded up */
+
+static unsigned long long admit_share(unsigned long long a, unsigned long long b) {
+	return (a * ADMIT_ONE + b - 1) / b;
+}
+
+/* Returns the total demand of the jobs of task that have both their release and deadline in [0, t] */
+
+static unsigned long long admit_task_demand(admit_task_t * task, unsigned long long t) {
+	if (t < task->deadline) {
+		return 0;
+	}
+	if (task->period == 0) {
+		return task->wcet;
+	}
+	return ((t - task->deadline) / task->period + 1) * task->wcet;
+}
+
+/* Returns the latest deadline of task before t, 0 if there is none */
+
+static unsigned long long admit_task_deadline_before(admit_task_t * task, unsigned long long t) {
+	if (task->deadline >= t) {
+		return 0;
+	}
+	if (task->period == 0) {
+		return task->deadline;
+	}
+	return task->deadline + (t - task->deadline - 1) / task->period * task->period;
+}
+
+/* Returns the processor demand h(t) of the set plus extra (may be NULL) */
+
+static unsigned long long admit_demand(admit_t * set, admit_task_t * extra, unsigned long long t) {
+	unsigned long long demand = (extra != NULL) ? admit_task_demand(extra, t) : 0;
+	admit_task_t * task;
+	for (task = set->tasks; task != NULL; task = task->next) {
+		demand += admit_task_demand(task, t);
+	}
+	return demand;
+}
+
+/* Returns the latest deadline of any job of the set plus extra before t, 0 if there is none */
+
+static unsigned long long admit_deadline_before(admit_t * set, admit_task_t * extra, unsigned long long t) {
+	unsigned long long latest = (extra != NULL) ? admit_task_deadline_before(extra, t) : 0;
+	admit_task_t * task;
+	for (task = set->tasks; task != NULL; task = task->next) {
+		unsigned long long d = admit_task_deadline_before(task, t);
+		if (d > latest) {
+			latest = d;
+		}
+	}
+	return latest;
+}
+
+/* Returns the length of the synchronous busy period of the set plus extra
+ * (total utilization at most 1), or limit if the busy period is at least
+ * that long or hasn't settled after RT_ADMIT_MAX_STEPS steps
+ */
+
+static unsigned long long admit_busy_period(admit_t * set, admit_task_t * extra, unsigned long long limit) {
+	unsigned long long busy = 0, next;
+	unsigned int steps = 0;
+	admit_task_t * task = (extra != NULL) ? extra : set->tasks;
+	admit_task_t * first = task;
+	for (; task != NULL; task = (task == extra) ? set->tasks : task->next) {
+		busy += task->wcet;
+	}
+	do { //Iterates w = sum of ceil(w / period) * wcet until it settles
+		if ((busy >= limit) || (++steps > RT_ADMIT_MAX_STEPS)) {
+			return limit;
+		}
+		next = 0;
+		for (task = first; task != NULL; task = (task == extra) ? set->tasks : task->next) {
+			next += (task->period == 0) ? task->wcet : (busy + task->period - 1) / task->period * task->wcet;
+		}
+		if (next == busy) {
+			break;
+		}
+		busy = next;
+	} while (1);
+	return busy;
+}
+
+#define ADMIT_NO_BOUND (~0ULL)
+
+/* Returns a / b as 32.32 fixed point for b at most ADMIT_ONE (a divided by
+ * a fixed point fraction), rounded up, or ADMIT_NO_BOUND if it does not fit
+ */
+
+static unsigned long long admit_scale(unsigned long long a, unsigned long long b) {
+	unsigned long long whole = a / b;
+	if (whole >= ADMIT_ONE) {
+		return ADMIT_NO_BOUND;
+	}
+	return whole * ADMIT_ONE + ((a % b) * ADMIT_ONE + b - 1) / b;
+}
+
+/* Returns an upper bound on the deadlines the demand test has to look at:
+ * the bound of Zhang and Burns if the utilization is below 1, or the busy
+ * period if that is shorter. Returns ADMIT_NO_BOUND if neither could be
+ * found. The bound is worked out in whole ticks rounded up, which only
+ * makes it larger.
+ */
+
+static unsigned long long admit_test_bound(admit_t * set, admit_task_t * extra, unsigned long long utilization) {
+	unsigned long long bound = ADMIT_NO_BOUND;
+	if (utilization < ADMIT_ONE) {
+		unsigned long long slack = 0; //The sum of (period - deadline) * utilization, plus the one-shot jobs
+		unsigned long long longest = 0; //The largest deadline - period
+		admit_task_t * task;
+		for (task = (extra != NULL) ? extra : set->tasks; task != NULL; task = (task == extra) ? set->tasks : task->next) {
+			if (task->period == 0) {
+				slack += task->wcet;
+			}
+			else if (task->deadline < task->period) {
+				slack += ((task->period - task->deadline) * task->utilization + ADMIT_ONE - 1) / ADMIT_ONE;
+			}
+			else if (task->deadline - task->period > longest) {
+				longest = task->deadline - task->period;
+			}
+		}
+		bound = admit_scale(slack, ADMIT_ONE - utilization); //slack / (1 - utilization)
+		if (bound != ADMIT_NO_BOUND) {
+			bound += 1;
+			if (bound < longest) {
+				bound = longest;
+			}
+		}
+	}
+	return admit_busy_period(set, extra, bound);
+}
+
+/* Initializes an empty task set */
+
+void admit_init(admit_t * set) {
+	set->tasks = NULL;
+	set->count = 0;
+	set->constrained = 0;
+	set->utilization = 0;
+	set->density = 0;
+	set->changes = 0;
+	set->additions = 0;
+}
+
+/* Runs the processor demand test (QPA) on the set plus task */
+
+int admit_demand_test(admit_t * set, admit_task_t * task) {
+	unsigned long long utilization = set->utilization;
+	unsigned long long stop = ~0ULL; //The test passes once h(t) is no later than this
+	unsigned long long t, demand;
+	unsigned int steps = 0;
+	admit_task_t * other;
+	if (task != NULL) {
+		utilization += (task->period == 0) ? 0 : admit_share(task->wcet, task->period);
+	}
+	if (utilization > ADMIT_ONE) {
+		return 0;
+	}
+	for (other = set->tasks; other != NULL; other = other->next) { //No demand is due before the first deadline
+		if (other->deadline < stop) {
+			stop = other->deadline;
+		}
+	}
+	if ((task != NULL) && ((task->deadline > stop) || (set->tasks == NULL))) { //The set was schedulable without task, so only the deadlines from task's first one on can fail
+		stop = task->deadline;
+	}
+	t = admit_test_bound(set, task, utilization);
+	if (t == ADMIT_NO_BOUND) { //Gives up on the safe side
+		return 0;
+	}
+	//Walks down from the last deadline that matters, jumping straight to h(t) whenever the demand is below t
+	t = admit_deadline_before(set, task, t + 1);
+	demand = admit_demand(set, task, t);
+	while ((demand <= t) && (demand > stop)) {
+		if (++steps > RT_ADMIT_MAX_STEPS) { //Gives up on the safe side
+			return 0;
+		}
+		if (demand < t) {
+			t = demand;
+		}
+		else {
+			t = admit_deadline_before(set, task, t);
+		}
+		demand = admit_demand(set, task, t);
+	}
+	return demand <= stop;
+}
+
+/* Runs the checks that only need the sums on the set without replaces plus task */
+
+int admit_quick(admit_t * set, admit_task_t * task, admit_task_t * replaces) {
+	unsigned long long window, utilization = set->utilization, density = set->density;
+	unsigned int constrained = set->constrained;
+	if ((task->wcet == 0) || (task->wcet > task->deadline) || ((task->period != 0) && (task->wcet > task->period))) {
+		return ADMIT_NO;
+	}
+	if (replaces != NULL) {
+		utilization -= replaces->utilization;
+		density -= replaces->density;
+		constrained -= (replaces->period == 0) || (replaces->deadline < replaces->period);
+	}
+	window = ((task->period == 0) || (task->deadline < task->period)) ? task->deadline : task->period;
+	constrained += (task->period == 0) || (task->deadline < task->period);
+	task->utilization = (task->period == 0) ? 0 : admit_share(task->wcet, task->period);
+	task->density = admit_share(task->wcet, window);
+	if (utilization + task->utilization > ADMIT_ONE) { //Overloaded
+		return ADMIT_NO;
+	}
+	if ((constrained != 0) && (density + task->density > ADMIT_ONE)) { //The cheap tests can't tell
+		return ADMIT_TEST;
+	}
+	return ADMIT_YES;
+}
+
+/* Adds task to the set without any test */
+
+void admit_insert(admit_t * set, admit_task_t * task) {
+	task->prev = NULL;
+	task->next = set->tasks;
+	if (set->tasks != NULL) {
+		set->tasks->prev = task;
+	}
+	set->tasks = task;
+	set->count += 1;
+	set->constrained += (task->period == 0) || (task->deadline < task->period);
+	set->utilization += task->utilization;
+	set->density += task->density;
+	set->changes += 1;
+	set->additions += 1;
+}
+
+/* Adds task to the set if the set stays schedulable */
+
+int admit_add(admit_t * set, admit_task_t * task) {
+	int fits = admit_quick(set, task, NULL);
+	if ((fits == ADMIT_NO) || ((fits == ADMIT_TEST) && !admit_demand_test(set, task))) {
+		return -1;
+	}
+	admit_insert(set, task);
+	return 0;
+}
+
+/* Takes an admitted task out of the set */
+
+void admit_remove(admit_t * set, admit_task_t * task) {
+	if (task->prev != NULL) {
+		task->prev->next = task->next;
+	}
+	else {
+		set->tasks = task->next;
+	}
+	if (task->next != NULL) {
+		task->next->prev = task->prev;
+	}
+	set->count -= 1;
+	set->constrained -= (task->period == 0) || (task->deadline < task->period);
+	set->utilization -= task->utilization;
+	set->density -= task->density;
+	set->changes += 1;
+}
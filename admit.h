@@ -0,0 +1,91 @@
+#ifndef __ADMIT_H__
+#define __ADMIT_H__
+
+/* EDF admission control for tasks with declared worst-case execution times.
+ *
+ * A task is a periodic (or sporadic) task with execution time wcet,
+ * relative deadline and period, or a one-shot job if period is 0. A new
+ * task is admitted only if the whole set stays schedulable by EDF on one
+ * processor:
+ *  - the total utilization must not exceed 1, which is also enough if no
+ *    task has a deadline shorter than its period (implicit deadlines);
+ *  - otherwise a total density (wcet / min(deadline, period)) of at most 1
+ *    is enough;
+ *  - otherwise the exact processor demand test is run with Quick
+ *    Processor-demand Analysis (QPA, Zhang and Burns).
+ * The utilization and density sums are kept up to date as tasks come and
+ * go, so the first two checks are O(1); only the demand test looks at
+ * every task. Times are in ticks.
+ *
+ * The sums are kept in fixed point with every term rounded up, so the
+ * checks err on the safe side: a set at exactly 100% utilization is
+ * refused unless every term is exact (e.g. power of two periods). The
+ * demand test also gives up and refuses the task after RT_ADMIT_MAX_STEPS
+ * (rtconfig.h) steps, which bounds its run time when the utilization is
+ * very close to 1.
+ */
+
+#include "rtconfig.h"
+
+#define ADMIT_ONE (1ULL << 32) /* a utilization or density of 1 (32.32 fixed point) */
+
+typedef struct admit_task {
+	unsigned long long wcet; /* the worst-case execution time of a job */
+	unsigned long long deadline; /* the deadline of a job relative to its release */
+	unsigned long long period; /* the time between releases, 0 for a one-shot job */
+	unsigned long long utilization; /* wcet / period, rounded up (set by admit_add) */
+	unsigned long long density; /* wcet / min(deadline, period), rounded up (set by admit_add) */
+	struct admit_task * next; /* the next admitted task */
+	struct admit_task * prev; /* the previous admitted task */
+} admit_task_t;
+
+typedef struct {
+	admit_task_t * tasks; /* the admitted tasks */
+	unsigned int count; /* the number of admitted tasks */
+	unsigned int constrained; /* the number of admitted tasks with a deadline shorter than their period (or one-shot) */
+	unsigned long long utilization; /* the total utilization */
+	unsigned long long density; /* the total density */
+	unsigned int changes; /* incremented by every admit_insert and admit_remove */
+	unsigned int additions; /* incremented by every admit_insert */
+} admit_t;
+
+/* What admit_quick found */
+#define ADMIT_NO 0 /* the set would not be schedulable */
+#define ADMIT_YES 1 /* the set stays schedulable */
+#define ADMIT_TEST 2 /* only admit_demand_test can tell */
+
+/* Initializes an empty task set */
+void admit_init(admit_t * set);
+
+/* Adds task to the set if the set stays schedulable (task->wcet, deadline
+ * and period must already be set). Returns 0 if it was admitted, -1 if
+ * not.
+ */
+int admit_add(admit_t * set, admit_task_t * task);
+
+/* Runs the checks of admit_add that only need the sums, for the set
+ * without replaces (an admitted task, NULL for none) plus task, and sets
+ * task->utilization and density. Returns ADMIT_NO, ADMIT_YES or
+ * ADMIT_TEST. O(1), so a caller can run it with interrupts disabled and
+ * leave the demand test for later (on a copy of the set, see
+ * admit_insert).
+ */
+int admit_quick(admit_t * set, admit_task_t * task, admit_task_t * replaces);
+
+/* Adds task to the set without any test (its utilization and density must
+ * already be set by admit_quick, or copied from another admitted task). A
+ * test that ran on a copy of the set still holds if set->additions did not
+ * change meanwhile: tasks that left only lower the demand.
+ */
+void admit_insert(admit_t * set, admit_task_t * task);
+
+/* Takes an admitted task out of the set */
+void admit_remove(admit_t * set, admit_task_t * task);
+
+/* Runs the processor demand test on the set as it is plus task (NULL for
+ * just the set), whatever the sums say. Returns 1 if it is schedulable, 0
+ * if not (or if the test gave up).
+ */
+int admit_demand_test(admit_t * set, admit_task_t * task);
+
+#endif
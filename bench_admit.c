@@ -0,0 +1,160 @@
+/* Host-side benchmark and cross-check of EDF admission control (admit.c).
+ *
+ * First checks the decisions of admit_add() against a brute-force
+ * processor demand check over the hyperperiod on thousands of small random
+ * task sets. Then admits random task sets of up to 1000 tasks at about
+ * 95% utilization one task at a time, with a mix of implicit and
+ * constrained deadlines, and reports the mean and worst cost of admitting
+ * a task next to the cost of running the demand test on the whole set.
+ *
+ * Build and run on the host:
+ *   gcc -O2 -o bench_admit bench_admit.c admit.c && ./bench_admit
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "admit.h"
+
+#define CHECK_SETS 5000 /* random sets for the cross-check */
+#define CHECK_HYPERPERIOD 200 /* the lcm of the periods the cross-check uses */
+
+static double now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Whether the set is schedulable: the utilization is at most 1 and
+ * h(t) <= t at every tick up to the hyperperiod plus the longest deadline.
+ * Returns 2 if it is only just schedulable at exactly 100% utilization,
+ * which admission control may refuse.
+ */
+
+static int brute_force(admit_task_t * tasks, int n) {
+	unsigned long long t, longest = 0, work = 0;
+	int i;
+	for (i = 0; i < n; i++) {
+		if (tasks[i].deadline > longest) {
+			longest = tasks[i].deadline;
+		}
+		work += tasks[i].wcet * (CHECK_HYPERPERIOD / tasks[i].period);
+	}
+	if (work > CHECK_HYPERPERIOD) {
+		return 0;
+	}
+	for (t = 1; t <= CHECK_HYPERPERIOD + longest; t++) {
+		unsigned long long demand = 0;
+		for (i = 0; i < n; i++) {
+			if (t >= tasks[i].deadline) {
+				demand += ((t - tasks[i].deadline) / tasks[i].period + 1) * tasks[i].wcet;
+			}
+		}
+		if (demand > t) {
+			return 0;
+		}
+	}
+	return (work == CHECK_HYPERPERIOD) ? 2 : 1;
+}
+
+/* Adds random small tasks one at a time and checks every decision */
+
+static int cross_check(void) {
+	static const unsigned long long periods[] = {10, 20, 25, 40, 50, 100, 200};
+	admit_task_t tasks[16];
+	admit_t set;
+	int s, i, n, admitted, rejected = 0, accepted = 0, full = 0;
+	srand(1);
+	for (s = 0; s < CHECK_SETS; s++) {
+		admit_init(&set);
+		admitted = 0;
+		n = 2 + rand() % 14;
+		for (i = 0; i < n; i++) {
+			admit_task_t * task = &tasks[admitted];
+			int fits;
+			task->period = periods[rand() % 7];
+			task->wcet = 1 + rand() % (task->period / 4);
+			task->deadline = task->wcet + rand() % (task->period + task->period / 2 - task->wcet + 1);
+			fits = (task->wcet <= task->deadline) ? brute_force(tasks, admitted + 1) : 0;
+			if ((fits == 2) && (admit_add(&set, task) != 0)) { //Refused at exactly 100%, on the safe side
+				full += 1;
+				rejected += 1;
+				continue;
+			}
+			if (fits == 2) {
+				fits = 1;
+			}
+			else if ((admit_add(&set, task) == 0) != fits) {
+				printf("MISMATCH in set %d: task %d (wcet %llu, deadline %llu, period %llu) admit_add %s, brute force %s\n",
+					s, i, task->wcet, task->deadline, task->period, fits ? "refused" : "admitted", fits ? "fits" : "doesn't fit");
+				return 1;
+			}
+			if (fits) {
+				admitted += 1;
+				accepted += 1;
+			}
+			else {
+				rejected += 1;
+			}
+		}
+	}
+	printf("cross-check: %d sets, %d tasks admitted and %d refused (%d at exactly 100%%), all agree with brute force\n",
+		CHECK_SETS, accepted, rejected, full);
+	return 0;
+}
+
+/* Random tasks with about 95% total utilization, periods from 10 ms to
+ * 10 s, and a deadline shorter than the period for a third of them
+ */
+
+static void make_tasks(admit_task_t * tasks, int n) {
+	int i;
+	srand(n);
+	for (i = 0; i < n; i++) {
+		double u = 0.95 / n * (0.5 + (double) rand() / RAND_MAX);
+		tasks[i].period = 10 + rand() % 9991;
+		tasks[i].wcet = (unsigned long long) (u * tasks[i].period);
+		if (tasks[i].wcet == 0) {
+			tasks[i].wcet = 1;
+		}
+		tasks[i].deadline = tasks[i].period;
+		if (rand() % 3 == 0) {
+			tasks[i].deadline = tasks[i].wcet + (tasks[i].period - tasks[i].wcet) * 3 / 4;
+		}
+	}
+}
+
+int main(void) {
+	static const int counts[] = {10, 100, 500, 1000};
+	unsigned int c;
+	if (cross_check()) {
+		return 1;
+	}
+	printf("%8s %9s %14s %14s %18s\n", "tasks", "admitted", "add mean ns", "add max ns", "full test ns");
+	for (c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+		int n = counts[c];
+		admit_task_t * tasks = malloc(n * sizeof(admit_task_t));
+		admit_t set;
+		double t0, dt, total = 0, worst = 0, full;
+		int i, admitted = 0;
+		make_tasks(tasks, n);
+		admit_init(&set);
+		for (i = 0; i < n; i++) {
+			t0 = now_ns();
+			if (admit_add(&set, &tasks[i]) == 0) {
+				admitted += 1;
+			}
+			dt = now_ns() - t0;
+			total += dt;
+			if (dt > worst) {
+				worst = dt;
+			}
+		}
+		t0 = now_ns();
+		admit_demand_test(&set, NULL);
+		full = now_ns() - t0;
+		printf("%8d %9d %14.1f %14.1f %18.1f\n", n, admitted, total / n, worst, full);
+		free(tasks);
+	}
+	return 0;
+}
@@ -0,0 +1,119 @@
+/* Host-side benchmark for the EDF ready queue.
+ *
+ * Compares the pairing heap in heap.c with the sorted linked list that
+ * add_ready_queue() used to walk. For each task count the queue is filled
+ * with n jobs and then driven in steady state: the earliest-deadline job is
+ * popped and re-inserted with a later deadline, the same pattern as a
+ * preemption or a periodic job being re-armed.
+ *
+ * Build and run on the host:
+ *   gcc -O2 -o bench_heap bench_heap.c heap.c && ./bench_heap
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "heap.h"
+
+#define BENCH_OPS 50000 /* the number of pop/insert pairs measured per task count */
+
+typedef struct job {
+	unsigned long long deadline;
+	struct job * next;
+	heap_node_t node;
+} job_t;
+
+static job_t * list_head;
+
+/* The old sorted insert from add_ready_queue() */
+
+static void list_insert(job_t * job) {
+	job_t * before = NULL;
+	job_t * after = list_head;
+	while ((after != NULL) && (job->deadline >= after->deadline)) {
+		before = after;
+		after = after->next;
+	}
+	job->next = after;
+	if (before != NULL) {
+		before->next = job;
+	}
+	else {
+		list_head = job;
+	}
+}
+
+static job_t * list_pop(void) {
+	job_t * job = list_head;
+	list_head = job->next;
+	job->next = NULL;
+	return job;
+}
+
+static double now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Deadlines spread over 10 seconds (in ms) like a set of mixed-period tasks */
+
+static unsigned long long next_deadline(unsigned long long now) {
+	return now + 1 + (unsigned long long) (rand() % 10000);
+}
+
+int main(void) {
+	static const int counts[] = {10, 100, 1000, 10000};
+	unsigned int c;
+	printf("%8s %14s %14s %14s %14s\n", "tasks", "heap ins ns", "heap pop ns", "list ins ns", "list pop ns");
+	for (c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+		int n = counts[c];
+		job_t * jobs = malloc(n * sizeof(job_t));
+		heap_t heap;
+		double t0, ins_ns = 0, pop_ns = 0;
+		unsigned long long now = 0;
+		int i;
+
+		srand(n);
+		heap_init(&heap);
+		for (i = 0; i < n; i++) {
+			jobs[i].node.key = next_deadline(now);
+			heap_insert(&heap, &jobs[i].node);
+		}
+		for (i = 0; i < BENCH_OPS; i++) {
+			heap_node_t * node;
+			t0 = now_ns();
+			node = heap_pop(&heap);
+			pop_ns += now_ns() - t0;
+			now = node->key;
+			node->key = next_deadline(now);
+			t0 = now_ns();
+			heap_insert(&heap, node);
+			ins_ns += now_ns() - t0;
+		}
+		printf("%8d %14.1f %14.1f", n, ins_ns / BENCH_OPS, pop_ns / BENCH_OPS);
+
+		srand(n);
+		list_head = NULL;
+		now = 0;
+		ins_ns = pop_ns = 0;
+		for (i = 0; i < n; i++) {
+			jobs[i].deadline = next_deadline(now);
+			list_insert(&jobs[i]);
+		}
+		for (i = 0; i < BENCH_OPS; i++) {
+			job_t * job;
+			t0 = now_ns();
+			job = list_pop();
+			pop_ns += now_ns() - t0;
+			now = job->deadline;
+			job->deadline = next_deadline(now);
+			t0 = now_ns();
+			list_insert(job);
+			ins_ns += now_ns() - t0;
+		}
+		printf(" %14.1f %14.1f\n", ins_ns / BENCH_OPS, pop_ns / BENCH_OPS);
+		free(jobs);
+	}
+	return 0;
+}
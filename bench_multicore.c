@@ -0,0 +1,115 @@
+/* Benchmark of partitioned EDF as the number of simulated cores grows.
+ *
+ * For 1, 2, 4 and 8 cores, random periodic task sets with implicit
+ * deadlines are generated like in bench_sched.c (UUniFast utilizations,
+ * log-uniform periods) with 12 tasks and a total utilization of 0.75 or
+ * 0.9 per core. Each set is partitioned with core_partition() and run on
+ * one thread per core with core_run(), and one CSV line per set is written
+ * to standard output: the tasks that fit on no core, the jobs and misses,
+ * context switches and scheduler time per job, the migrations, and the
+ * throughput in jobs per wall clock second.
+ *
+ * Jobs never migrate under partitioned EDF, so the migrations are always
+ * 0; the column is there to compare against other policies. Tasks that fit
+ * on no core are left out of the run (a global scheduler could run some of
+ * them). EDF meets every deadline on a core whose tasks passed the
+ * admission test, so the benchmark exits with 1 if a placed task misses
+ * one. The throughput only scales while there are free host CPUs.
+ *
+ * Build and run on the host with pools for up to 64 tasks per core:
+ *   gcc -DRT_HOST -DRT_MULTICORE -O2 -pthread -DRT_MAX_PROCESSES=64 -DRT_STACK_COUNT_0=64 -DHOST_STACK_BYTES=16384 \
+ *       -o bench_multicore bench_multicore.c bench_util.c multicore.c process.c 3140_host.c heap.c twheel.c tick.c pool.c instr.c admit.c trace.c -lm && ./bench_multicore > bench_multicore.csv
+ * Give a core count as the argument to stop at fewer cores.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "multicore.h"
+#include "admit.h"
+#include "host.h"
+#include "bench_util.h"
+
+#define BENCH_STACK 16 /* words of stack per task, the smallest class fits them all */
+
+#define BENCH_TASKS_PER_CORE 12
+
+#define BENCH_SEEDS 3 /* sets per core count and utilization */
+
+#define BENCH_MIN_PERIOD 20 /* ms */
+#define BENCH_MAX_PERIOD 2000
+
+#define BENCH_SIM (10 * BENCH_MAX_PERIOD) /* simulated ms per set */
+
+/* Every task runs this, for its execution time */
+
+static void bench_job(void) {
+	host_run(tick_from_realtime(&core_task()->wcet));
+}
+
+/* Generates, partitions and runs one set, writes its CSV line and returns whether it was correct */
+
+static int run_set(int cores, double load, int seed) {
+	static double u[BENCH_TASKS_PER_CORE * CORE_MAX];
+	static core_task_t tasks[BENCH_TASKS_PER_CORE * CORE_MAX];
+	core_stats_t stats[CORE_MAX];
+	int n = BENCH_TASKS_PER_CORE * cores;
+	int i, core, unplaced;
+	unsigned long long jobs = 0, misses = 0, switches = 0, select_ns = 0;
+	double wall = 0;
+	srand(seed * 7919 + cores * 31 + (int) (load * 100));
+	uunifast(u, n, load * cores);
+	for (i = 0; i < n; i++) {
+		double lo = log(BENCH_MIN_PERIOD), hi = log(BENCH_MAX_PERIOD);
+		unsigned int period = (unsigned int) exp(lo + (hi - lo) * uniform());
+		unsigned int wcet = (unsigned int) (u[i] * period);
+		core_task_t task = {bench_job, BENCH_STACK, {0, 0}, {0, 0}, {0, 0}, {0, 0}, -1};
+		tick_to_realtime(period, &task.deadline);
+		tick_to_realtime(period, &task.period);
+		tick_to_realtime(wcet ? wcet : 1, &task.wcet);
+		tasks[i] = task;
+	}
+	unplaced = core_partition(tasks, n, cores);
+	if (core_run(tasks, n, cores, BENCH_SIM, stats) != 0) {
+		fprintf(stderr, "could not create the tasks of a set on %d cores\n", cores);
+		return 0;
+	}
+	for (core = 0; core < cores; core++) {
+		jobs += stats[core].jobs_met + stats[core].jobs_missed;
+		misses += stats[core].jobs_missed;
+		switches += stats[core].switches;
+		select_ns += stats[core].select_ns;
+		if (stats[core].wall_ms > wall) {
+			wall = stats[core].wall_ms;
+		}
+	}
+	printf("%d,%d,%.2f,%d,%d,%llu,%llu,%.6f,%.3f,%.1f,0,%.1f,%.0f\n",
+		cores, n, load, seed, unplaced, jobs, misses,
+		jobs ? (double) misses / jobs : 0.0,
+		jobs ? (double) switches / jobs : 0.0,
+		jobs ? (double) select_ns / jobs : 0.0,
+		wall, wall > 0 ? jobs * 1e3 / wall : 0.0);
+	fflush(stdout);
+	return misses == 0;
+}
+
+int main(int argc, char ** argv) {
+	static const int counts[] = {1, 2, 4, 8};
+	static const double loads[] = {0.75, 0.9};
+	int limit = (argc > 1) ? atoi(argv[1]) : CORE_MAX;
+	int c, l, seed, failures = 0;
+	printf("cores,tasks,load_per_core,seed,unplaced,jobs,misses,miss_ratio,switches_per_job,select_ns_per_job,migrations,wall_ms,jobs_per_wall_s\n");
+	for (c = 0; (c < (int) (sizeof(counts) / sizeof(counts[0]))) && (counts[c] <= limit); c++) {
+		for (l = 0; l < (int) (sizeof(loads) / sizeof(loads[0])); l++) {
+			for (seed = 1; seed <= BENCH_SEEDS; seed++) {
+				if (!run_set(counts[c], loads[l], seed)) {
+					failures++;
+				}
+			}
+		}
+	}
+	if (failures > 0) {
+		fprintf(stderr, "%d sets missed deadlines on a core that admitted its tasks\n", failures);
+	}
+	return failures > 0;
+}
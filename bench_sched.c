@@ -0,0 +1,151 @@
+/* Schedulability and overhead benchmark of the scheduler on random task sets.
+ *
+ * Generates periodic task sets with implicit deadlines: the utilizations
+ * come from UUniFast (Bini and Buttazzo), which spreads a total
+ * utilization uniformly over the tasks, and the periods are log-uniform.
+ * Every set is run on the host simulation backend and one CSV line per
+ * set is written to standard output with the miss ratio, the scheduler
+ * time and context switches per job, and the pool memory the set takes.
+ *
+ * The scheduler cost is wall clock time on the host (port_cycles counts
+ * nanoseconds there, see host.h), not processor cycles: the host has no
+ * cycle counter that stands for the board. The columns show the cost of
+ * one process_select call, the PIT0 ticks per job that return to the
+ * running process without calling it, and the time those ticks save per
+ * job at that cost. The cycle counts on the board come from an
+ * RT_INSTRUMENT build (INSTR_SELECT and INSTR_SWITCH, DWT->CYCCNT).
+ *
+ * Execution times are whole ticks, so they are rounded down (to at least
+ * one tick) and the actual utilization of a set is reported next to the
+ * target. Periods are scaled with the number of tasks to keep that
+ * rounding small, and each set runs for ten of the longest possible
+ * periods. EDF meets every deadline of a set with an actual utilization
+ * of at most 1, so the benchmark exits with 1 if one of those misses a
+ * deadline, which makes it usable as a regression gate.
+ *
+ * The sets only go up to the pool sizes in rtconfig.h. Build and run on
+ * the host with pools for up to 2000 tasks:
+ *   gcc -DRT_HOST -O2 -DRT_MAX_PROCESSES=2000 -DRT_STACK_COUNT_0=2000 -DRT_MAX_TASK_STATS=16 -DHOST_STACK_BYTES=16384 \
+ *       -o bench_sched bench_sched.c bench_util.c process.c 3140_host.c heap.c twheel.c tick.c pool.c instr.c admit.c trace.c -lm && ./bench_sched > bench_sched.csv
+ * Add -DRT_TICKLESS to compare the tickless mode, and give a task count as
+ * the argument to stop at smaller sets.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include "3140_concur.h"
+#include "realtime.h"
+#include "host.h"
+#include "bench_util.h"
+#include "rtconfig.h"
+
+#define BENCH_STACK 16 /* words of stack per task, the smallest class fits them all */
+
+#define BENCH_SEEDS 3 /* sets per task count and utilization */
+
+#define BENCH_MIN_PERIOD 10 /* ms, times the period scale */
+#define BENCH_MAX_PERIOD 1000
+
+static unsigned int wcet[RT_MAX_PROCESSES + 1]; /* the execution time of each task, by process id */
+
+/* Every task runs this, for the execution time of its process id */
+
+static void bench_job(void) {
+	host_run(wcet[process_id()]);
+}
+
+/* Returns the bytes of every pool block in use */
+
+static unsigned long pool_bytes(void) {
+	unsigned long bytes = 0;
+	pool_stats_t stats;
+	int pool;
+	for (pool = 0; process_pool_stats(pool, &stats) == 0; pool++) {
+		bytes += (unsigned long) stats.used * stats.block_size;
+	}
+	return bytes;
+}
+
+/* Generates and runs one set, writes its CSV line and returns whether it was correct */
+
+static int run_set(int n, double target, int seed) {
+	static double u[RT_MAX_PROCESSES];
+	double scale = (n > 10) ? n / 10.0 : 1.0;
+	double actual = 0;
+	unsigned long long sim = (unsigned long long) (10 * BENCH_MAX_PERIOD * scale);
+	unsigned int jobs;
+	unsigned long memory;
+	double per_call;
+	struct timespec t0, t1;
+	int i;
+	srand(seed * 7919 + n * 31 + (int) (target * 100));
+	uunifast(u, n, target);
+	process_deadline_met = 0;
+	process_deadline_miss = 0;
+	for (i = 0; i < n; i++) {
+		double lo = log(BENCH_MIN_PERIOD * scale), hi = log(BENCH_MAX_PERIOD * scale);
+		unsigned int period = (unsigned int) exp(lo + (hi - lo) * uniform());
+		realtime_t start = {0, 0};
+		realtime_t t_period;
+		wcet[i + 1] = (unsigned int) (u[i] * period);
+		if (wcet[i + 1] == 0) {
+			wcet[i + 1] = 1;
+		}
+		actual += (double) wcet[i + 1] / period;
+		tick_to_realtime(period, &t_period);
+		if (process_rt_periodic(bench_job, BENCH_STACK, &start, &t_period, &t_period) != 0) {
+			fprintf(stderr, "could not create task %d of %d\n", i + 1, n);
+			return 0;
+		}
+	}
+	memory = pool_bytes();
+	host_stop_at(sim);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	process_start();
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	host_stop_at(0);
+	jobs = process_deadline_met + process_deadline_miss;
+	per_call = host_stats.selects ? (double) host_stats.select_ns / host_stats.selects : 0.0;
+	printf("%d,%.2f,%.4f,%d,%u,%d,%.6f,%llu,%.3f,%.1f,%.3f,%.1f,%.3f,%.1f,%lu,%llu,%.1f\n",
+		n, target, actual, seed, jobs, process_deadline_miss,
+		jobs ? (double) process_deadline_miss / jobs : 0.0,
+		host_stats.switches, jobs ? (double) host_stats.switches / jobs : 0.0,
+		jobs ? (double) host_stats.select_ns / jobs : 0.0,
+		jobs ? (double) host_stats.selects / jobs : 0.0, per_call,
+		jobs ? (double) host_stats.elided / jobs : 0.0,
+		jobs ? (double) host_stats.elided * per_call / jobs : 0.0, //The process_select calls the elided ticks would have made
+		memory, sim,
+		(t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6);
+	fflush(stdout);
+	return (actual > 1.0) || (process_deadline_miss == 0);
+}
+
+int main(int argc, char ** argv) {
+	static const int counts[] = {2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000};
+	static const double targets[] = {0.5, 0.8, 0.95, 1.05};
+	int limit = (argc > 1) ? atoi(argv[1]) : RT_MAX_PROCESSES;
+	int c, t, seed, failures = 0;
+	if ((limit > RT_MAX_PROCESSES) || (limit > RT_STACK_COUNT_0 + RT_STACK_COUNT_1 + RT_STACK_COUNT_2 + RT_STACK_COUNT_3)) {
+		limit = RT_MAX_PROCESSES;
+		if (limit > RT_STACK_COUNT_0 + RT_STACK_COUNT_1 + RT_STACK_COUNT_2 + RT_STACK_COUNT_3) {
+			limit = RT_STACK_COUNT_0 + RT_STACK_COUNT_1 + RT_STACK_COUNT_2 + RT_STACK_COUNT_3;
+		}
+		fprintf(stderr, "the pools in rtconfig.h only hold %d tasks\n", limit);
+	}
+	printf("tasks,target_util,actual_util,seed,jobs,misses,miss_ratio,switches,switches_per_job,select_ns_per_job,selects_per_job,select_ns_per_call,elided_ticks_per_job,saved_ns_per_job,pool_bytes,sim_ms,wall_ms\n");
+	for (c = 0; (c < (int) (sizeof(counts) / sizeof(counts[0]))) && (counts[c] <= limit); c++) {
+		for (t = 0; t < (int) (sizeof(targets) / sizeof(targets[0])); t++) {
+			for (seed = 1; seed <= BENCH_SEEDS; seed++) {
+				if (!run_set(counts[c], targets[t], seed)) {
+					failures++;
+				}
+			}
+		}
+	}
+	if (failures > 0) {
+		fprintf(stderr, "%d sets with a utilization of at most 1 missed deadlines\n", failures);
+	}
+	return failures > 0;
+}
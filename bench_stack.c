@@ -0,0 +1,178 @@
+/* Stack memory and dispatch benchmark of basic tasks (rt_attr_t.basic).
+ *
+ * Generates periodic task sets with implicit deadlines like bench_sched.c
+ * (UUniFast utilizations), but with the periods drawn from a few rate
+ * groups, as in most control software, and a random stack of 16 to 64
+ * words per task. Every set is run twice on the host simulation backend,
+ * once with a stack per task and once with every task basic on the shared
+ * stack, and one CSV line per run is written to standard output: the
+ * stack memory taken from the pools, the words of the shared stack the
+ * deepest preemption chain can take (one task per rate group, the largest
+ * stack) and the most it did take, and the scheduler time and context
+ * switches per job.
+ *
+ * Each job uses all of its stack (host_stack_use) before it computes, so
+ * the measured chain is as deep as the preemptions of the run made it.
+ * The execution times are whole ticks of at least one, so the utilization
+ * a set really has (util) can be above its target; the benchmark exits
+ * with 1 if a set that fits (util <= 1) misses a deadline in either run,
+ * or if a chain is deeper than its bound.
+ *
+ * On the host the scheduler time of a dispatch includes making a ucontext
+ * for both kinds; on the board a new job costs four stores either way
+ * (process_stack_reset or process_stack_frame), so the saving there is
+ * the memory.
+ *
+ * Build and run on the host with pools for up to 48 tasks and a shared
+ * stack for the 7 rate groups:
+ *   gcc -DRT_HOST -O2 -DRT_MAX_PROCESSES=48 -DRT_STACK_COUNT_0=48 -DRT_STACK_COUNT_1=48 -DRT_STACK_WORDS_3=600 \
+ *       -DRT_SHARED_STACK_WORDS=560 -DHOST_STACK_BYTES=16384 \
+ *       -o bench_stack bench_stack.c bench_util.c process.c 3140_host.c heap.c twheel.c tick.c pool.c instr.c admit.c trace.c event.c -lm && ./bench_stack > bench_stack.csv
+ * Give a task count as the argument to stop at smaller sets.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "3140_concur.h"
+#include "realtime.h"
+#include "host.h"
+#include "bench_util.h"
+#include "rtconfig.h"
+
+#define BENCH_MIN_STACK 16 /* words of stack per task */
+#define BENCH_MAX_STACK 64
+
+#define BENCH_SEEDS 3 /* sets per task count and utilization */
+
+#define BENCH_SIM 10000 /* simulated ms per run */
+
+static const unsigned int rate_groups[] = {20, 50, 100, 200, 500, 1000, 2000}; /* the periods, ms */
+
+#define BENCH_GROUPS ((int) (sizeof(rate_groups) / sizeof(rate_groups[0])))
+
+static unsigned int wcet[RT_MAX_PROCESSES + 1]; /* the execution time of each task, by process id */
+static unsigned int stack[RT_MAX_PROCESSES + 1]; /* the stack of each task, by process id */
+static unsigned int chain_max; /* the most words any job has seen in use on its stack */
+
+/* Every task runs this, with the stack and for the execution time of its process id */
+
+static void bench_job(void) {
+	unsigned int used;
+	host_stack_use(stack[process_id()]);
+	used = process_stack_high_water();
+	if (used > chain_max) {
+		chain_max = used;
+	}
+	host_run(wcet[process_id()]);
+}
+
+/* Returns the bytes of the stack pool blocks in use */
+
+static unsigned long stack_bytes(void) {
+	unsigned long bytes = 0;
+	pool_stats_t stats;
+	int pool;
+	for (pool = 1; process_pool_stats(pool, &stats) == 0; pool++) {
+		bytes += (unsigned long) stats.used * stats.block_size;
+	}
+	return bytes;
+}
+
+/* Runs the set in periods, and writes its CSV line. Returns the misses, -1 if it could not be created or
+   its chain went past the bound */
+
+static int run_kind(int n, double target, double util, int seed, const unsigned int * periods, int basic) {
+	unsigned int groups[BENCH_GROUPS] = {0};
+	unsigned int bound = 0;
+	unsigned long memory;
+	unsigned int jobs;
+	rt_attr_t attr;
+	int i;
+	rt_attr_init(&attr);
+	attr.basic = basic;
+	process_deadline_met = 0;
+	process_deadline_miss = 0;
+	chain_max = 0;
+	for (i = 0; i < n; i++) {
+		realtime_t start = {0, 0};
+		realtime_t t_period;
+		int g;
+		tick_to_realtime(periods[i], &t_period);
+		if (process_rt_periodic_attr(bench_job, stack[i + 1], &start, &t_period, &t_period, &attr) != 0) {
+			fprintf(stderr, "could not create task %d of %d\n", i + 1, n);
+			process_stop(); //Throws away the ones that were created
+			process_start();
+			return -1;
+		}
+		for (g = 0; rate_groups[g] != periods[i]; g++) {
+		}
+		if (stack[i + 1] + PROCESS_CONTEXT_WORDS > groups[g]) {
+			groups[g] = stack[i + 1] + PROCESS_CONTEXT_WORDS;
+		}
+	}
+	for (i = 0; i < BENCH_GROUPS; i++) {
+		bound += groups[i];
+	}
+	memory = stack_bytes();
+	host_stop_at(BENCH_SIM);
+	process_start();
+	host_stop_at(0);
+	jobs = process_deadline_met + process_deadline_miss;
+	printf("%d,%.2f,%.3f,%d,%s,%u,%d,%lu,%u,%u,%llu,%.3f,%.1f\n",
+		n, target, util, seed, basic ? "basic" : "own", jobs, process_deadline_miss, memory,
+		basic ? bound - PROCESS_CONTEXT_WORDS : 0, basic ? chain_max : 0,
+		host_stats.switches, jobs ? (double) host_stats.switches / jobs : 0.0,
+		jobs ? (double) host_stats.select_ns / jobs : 0.0);
+	fflush(stdout);
+	if (basic && (chain_max > bound - PROCESS_CONTEXT_WORDS)) {
+		return -1;
+	}
+	return process_deadline_miss;
+}
+
+/* Generates one set and runs it both ways. Returns whether both runs were correct */
+
+static int run_set(int n, double target, int seed) {
+	static double u[RT_MAX_PROCESSES];
+	static unsigned int periods[RT_MAX_PROCESSES];
+	double util = 0.0;
+	int own, basic, i;
+	srand(seed * 7919 + n * 31 + (int) (target * 100));
+	uunifast(u, n, target);
+	for (i = 0; i < n; i++) {
+		periods[i] = rate_groups[rand() % BENCH_GROUPS];
+		wcet[i + 1] = (unsigned int) (u[i] * periods[i]);
+		if (wcet[i + 1] == 0) {
+			wcet[i + 1] = 1;
+		}
+		util += (double) wcet[i + 1] / periods[i];
+		stack[i + 1] = BENCH_MIN_STACK + rand() % (BENCH_MAX_STACK - BENCH_MIN_STACK + 1);
+	}
+	own = run_kind(n, target, util, seed, periods, 0);
+	basic = run_kind(n, target, util, seed, periods, 1);
+	return (own >= 0) && (basic >= 0) && ((util > 1.0) || ((own == 0) && (basic == 0)));
+}
+
+int main(int argc, char ** argv) {
+	static const int counts[] = {4, 8, 16, 32, 48};
+	static const double targets[] = {0.5, 0.8};
+	int limit = (argc > 1) ? atoi(argv[1]) : RT_MAX_PROCESSES;
+	int c, t, seed, failures = 0;
+	if (limit > RT_MAX_PROCESSES) {
+		limit = RT_MAX_PROCESSES;
+	}
+	printf("tasks,target_util,util,seed,kind,jobs,misses,stack_bytes,chain_bound_words,chain_max_words,switches,switches_per_job,select_ns_per_job\n");
+	for (c = 0; (c < (int) (sizeof(counts) / sizeof(counts[0]))) && (counts[c] <= limit); c++) {
+		for (t = 0; t < (int) (sizeof(targets) / sizeof(targets[0])); t++) {
+			for (seed = 1; seed <= BENCH_SEEDS; seed++) {
+				if (!run_set(counts[c], targets[t], seed)) {
+					failures++;
+				}
+			}
+		}
+	}
+	if (failures > 0) {
+		fprintf(stderr, "%d sets ran differently on the shared stack or missed deadlines\n", failures);
+	}
+	return failures > 0;
+}
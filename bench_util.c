@@ -0,0 +1,27 @@
+#include <stdlib.h>
+#include <math.h>
+#include "bench_util.h"
+
+/* Returns a number drawn uniformly from (0, 1) */
+
+double uniform(void) {
+	return (rand() + 1.0) / (RAND_MAX + 2.0);
+}
+
+/* Fills u with n utilizations that add up to total (UUniFast), redrawing while one is above 1 */
+
+void uunifast(double * u, int n, double total) {
+	int i, again;
+	do {
+		double sum = total;
+		again = 0;
+		for (i = 0; i < n - 1; i++) {
+			double next = sum * pow(uniform(), 1.0 / (n - 1 - i));
+			u[i] = sum - next;
+			sum = next;
+			again |= (u[i] > 1.0);
+		}
+		u[n - 1] = sum;
+		again |= (sum > 1.0);
+	} while (again);
+}
@@ -0,0 +1,17 @@
+#ifndef __BENCH_UTIL_H__
+#define __BENCH_UTIL_H__
+
+/* Random task set helpers shared by the host benchmarks (bench_sched.c,
+ * bench_multicore.c, bench_stack.c). They draw from rand(), so a benchmark
+ * seeds it with srand() to make a set again.
+ */
+
+/* Returns a number drawn uniformly from (0, 1) */
+double uniform(void);
+
+/* Fills u with n utilizations that add up to total (UUniFast, Bini and
+ * Buttazzo), redrawing while one is above 1
+ */
+void uunifast(double * u, int n, double total);
+
+#endif
@@ -0,0 +1,174 @@
+/* Host-side stress test for the not ready queue.
+ *
+ * Simulates thousands of periodic tasks for one minute of 1 ms ticks. On
+ * every tick the jobs that have arrived are released and immediately
+ * re-armed for their next period, once through the timing wheel in
+ * twheel.c and once through the arrival-sorted list that
+ * add_not_ready_queue() used to walk. Both must release exactly the same
+ * jobs on the same ticks; the mean and worst cost of a tick is reported.
+ * A third run drives the wheel tickless, sleeping until twheel_next(),
+ * and must release the same jobs with far fewer wakeups.
+ *
+ * Build and run on the host:
+ *   gcc -O2 -o bench_wheel bench_wheel.c twheel.c && ./bench_wheel
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <time.h>
+#include "twheel.h"
+
+#define BENCH_TICKS 60000 /* one minute of PIT1 ticks */
+
+typedef struct task {
+	unsigned long long period;
+	unsigned long long arrival;
+	struct task * next;
+	twheel_node_t node;
+} task_t;
+
+#define TASK_OF(n) ((task_t *) ((char *) (n) - offsetof(task_t, node)))
+
+static task_t * list_head;
+
+/* The old sorted insert from add_not_ready_queue() */
+
+static void list_insert(task_t * task) {
+	task_t * before = NULL;
+	task_t * after = list_head;
+	while ((after != NULL) && (task->arrival >= after->arrival)) {
+		before = after;
+		after = after->next;
+	}
+	task->next = after;
+	if (before != NULL) {
+		before->next = task;
+	}
+	else {
+		list_head = task;
+	}
+}
+
+static double now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Periods between 10 ms and 10 s with first releases spread over one period */
+
+static void make_tasks(task_t * tasks, int n) {
+	int i;
+	srand(n);
+	for (i = 0; i < n; i++) {
+		tasks[i].period = 10 + rand() % 9991;
+		tasks[i].arrival = rand() % tasks[i].period;
+	}
+}
+
+/* Runs the tasks through the wheel. In tickless mode the clock jumps
+ * straight to twheel_next() instead of stepping every tick, the way
+ * process_select() sleeps in RT_TICKLESS builds.
+ */
+
+static void wheel_run(task_t * tasks, int n, int tickless, unsigned long long * released,
+		unsigned long long * sum, unsigned long long * wakeups, double * mean_ns, double * max_ns) {
+	twheel_t * wheel = malloc(sizeof(twheel_t));
+	unsigned long long tick = 0;
+	double t0, dt, total_ns = 0;
+	int i;
+	make_tasks(tasks, n);
+	twheel_init(wheel, 0);
+	for (i = 0; i < n; i++) {
+		tasks[i].node.expires = tasks[i].arrival;
+		twheel_insert(wheel, &tasks[i].node);
+	}
+	*released = *sum = *wakeups = 0;
+	*max_ns = 0;
+	while (1) {
+		twheel_node_t * node;
+		if (tickless) {
+			unsigned long long next = twheel_next(wheel);
+			tick = (next > tick) ? next : tick + 1;
+		}
+		else {
+			tick += 1;
+		}
+		if (tick > BENCH_TICKS) {
+			break;
+		}
+		*wakeups += 1;
+		t0 = now_ns();
+		node = twheel_advance(wheel, tick);
+		while (node != NULL) {
+			twheel_node_t * next = node->next;
+			task_t * task = TASK_OF(node);
+			*released += 1;
+			*sum += task->arrival * (task - tasks);
+			task->arrival += task->period;
+			node->expires = task->arrival;
+			twheel_insert(wheel, node);
+			node = next;
+		}
+		dt = now_ns() - t0;
+		total_ns += dt;
+		if (dt > *max_ns) {
+			*max_ns = dt;
+		}
+	}
+	*mean_ns = total_ns / *wakeups;
+	free(wheel);
+}
+
+int main(void) {
+	static const int counts[] = {10, 1000, 5000, 10000};
+	unsigned int c;
+	printf("%8s %10s %14s %14s %14s %14s %16s\n", "tasks", "releases", "wheel mean ns", "wheel max ns",
+		"list mean ns", "list max ns", "tickless wakeups");
+	for (c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+		int n = counts[c];
+		task_t * tasks = malloc(n * sizeof(task_t));
+		unsigned long long tick, wheel_released, wheel_sum, wakeups;
+		unsigned long long tickless_released, tickless_sum, tickless_wakeups;
+		unsigned long long list_released = 0, list_sum = 0;
+		double t0, dt, wheel_ns, wheel_max, tickless_ns, tickless_max, list_ns = 0, list_max = 0;
+		int i;
+
+		wheel_run(tasks, n, 0, &wheel_released, &wheel_sum, &wakeups, &wheel_ns, &wheel_max);
+		wheel_run(tasks, n, 1, &tickless_released, &tickless_sum, &tickless_wakeups, &tickless_ns, &tickless_max);
+
+		make_tasks(tasks, n);
+		list_head = NULL;
+		for (i = 0; i < n; i++) {
+			list_insert(&tasks[i]);
+		}
+		for (tick = 1; tick <= BENCH_TICKS; tick++) {
+			t0 = now_ns();
+			while ((list_head != NULL) && (list_head->arrival <= tick)) {
+				task_t * task = list_head;
+				list_head = task->next;
+				list_released += 1;
+				list_sum += task->arrival * (task - tasks);
+				task->arrival += task->period;
+				list_insert(task);
+			}
+			dt = now_ns() - t0;
+			list_ns += dt;
+			if (dt > list_max) {
+				list_max = dt;
+			}
+		}
+
+		if ((wheel_released != list_released) || (wheel_sum != list_sum)
+				|| (tickless_released != list_released) || (tickless_sum != list_sum)) {
+			printf("%8d MISMATCH: wheel released %llu jobs, tickless wheel %llu jobs, list %llu jobs\n",
+				n, wheel_released, tickless_released, list_released);
+			return 1;
+		}
+		printf("%8d %10llu %14.1f %14.1f %14.1f %14.1f %16llu\n", n, wheel_released,
+			wheel_ns, wheel_max, list_ns / BENCH_TICKS, list_max, tickless_wakeups);
+		free(tasks);
+	}
+	return 0;
+}
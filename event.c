@@ -0,0 +1,121 @@
+#include <string.h>
+#include "event.h"
+#include "port.h"
+
+/* Makes the message visible before the head that publishes it */
+#ifdef RT_HOST
+#define event_barrier() __sync_synchronize()
+#else
+#define event_barrier() __DMB()
+#endif
+
+/* Returns whether flags satisfy what their waiter waits for */
+
+static int flags_ready(const rt_flags_t * flags, unsigned int mask, int all) {
+	unsigned int set = flags->flags & mask;
+	return all ? (set == mask) : (set != 0);
+}
+
+/* Initializes an empty queue */
+
+int rt_queue_init(rt_queue_t * queue, void * buffer, unsigned int size, unsigned int capacity) {
+	if ((capacity == 0) || ((capacity & (capacity - 1)) != 0)) {
+		return -1;
+	}
+	queue->wait.waiter = NULL;
+	queue->wait.posted = 0;
+	queue->wait.signalled = 0;
+	queue->buffer = buffer;
+	queue->size = size;
+	queue->capacity = capacity;
+	queue->head = 0;
+	queue->tail = 0;
+	return 0;
+}
+
+/* Copies the message in and publishes it, only the producer writes the head */
+
+int rt_queue_post(rt_queue_t * queue, const void * message) {
+	unsigned int head = queue->head;
+	if (head - queue->tail >= queue->capacity) {
+		return -1;
+	}
+	memcpy(queue->buffer + (head & (queue->capacity - 1)) * queue->size, message, queue->size);
+	event_barrier();
+	queue->head = head + 1;
+	process_event_post(&queue->wait);
+	return 0;
+}
+
+/* Takes the oldest message, waiting for one if there is none */
+
+int rt_queue_receive(rt_queue_t * queue, void * message) {
+	port_irq_disable(); //Only against the post that would have to wake this process, posting itself needs no lock
+	while (queue->head == queue->tail) {
+		if (process_event_wait(&queue->wait) != 0) {
+			port_irq_enable();
+			return -1;
+		}
+	}
+	port_irq_enable();
+	return rt_queue_try_receive(queue, message);
+}
+
+/* Copies the message out and frees its slot, only the consumer writes the tail */
+
+int rt_queue_try_receive(rt_queue_t * queue, void * message) {
+	unsigned int tail = queue->tail;
+	if (queue->head == tail) {
+		return -1;
+	}
+	event_barrier();
+	memcpy(message, queue->buffer + (tail & (queue->capacity - 1)) * queue->size, queue->size);
+	event_barrier();
+	queue->tail = tail + 1;
+	return 0;
+}
+
+/* Initializes flags with every flag clear */
+
+void rt_flags_init(rt_flags_t * flags) {
+	flags->wait.waiter = NULL;
+	flags->wait.posted = 0;
+	flags->wait.signalled = 0;
+	flags->flags = 0;
+	flags->mask = 0;
+	flags->all = 0;
+}
+
+/* Sets flags and wakes the waiter if that is what it waits for */
+
+void rt_flags_set(rt_flags_t * flags, unsigned int set) {
+#ifdef RT_HOST
+	flags->flags |= set;
+#else
+	unsigned int old;
+	do { //Handlers of different priorities may set flags at once
+		old = __LDREXW(&flags->flags);
+	} while (__STREXW(old | set, &flags->flags));
+#endif
+	if ((flags->wait.waiter != NULL) && flags_ready(flags, flags->mask, flags->all)) {
+		process_event_post(&flags->wait);
+	}
+}
+
+/* Waits for flags and takes the ones it waited for */
+
+int rt_flags_wait(rt_flags_t * flags, unsigned int mask, int all, unsigned int * got) {
+	port_irq_disable(); //Also makes the clear below atomic against rt_flags_set
+	flags->mask = mask;
+	flags->all = all;
+	while (!flags_ready(flags, mask, all)) {
+		if (process_event_wait(&flags->wait) != 0) {
+			port_irq_enable();
+			return -1;
+		}
+	}
+	*got = flags->flags & mask;
+	flags->flags &= ~*got;
+	port_irq_enable();
+	return 0;
+}
@@ -0,0 +1,105 @@
+#ifndef __EVENT_H__
+#define __EVENT_H__
+
+/* Message queues and event flags that interrupt handlers post to and
+ * processes wait on.
+ *
+ * A queue is a fixed-capacity ring of fixed-size messages with one
+ * producer and one consumer: one interrupt handler (or process) posts and
+ * one process receives. Event flags are a word of bits that any number of
+ * interrupt handlers set and one process waits on. Posting needs no lock:
+ * a queue only needs the producer to write the head and the consumer the
+ * tail, and flags are set with an atomic read-modify-write, so the
+ * handlers of every priority may post at any time. Only a post that wakes
+ * a waiter disables interrupts, for as long as it takes to read the time.
+ *
+ * A process that waits on an empty queue (or on flags that are not set)
+ * gives up the processor until something is posted. A realtime process
+ * that waits ends its job there, and the post releases its next job with
+ * the post time as arrival time and a deadline one relative deadline
+ * later, which makes it a sporadic task driven by the interrupt (a
+ * constant bandwidth server gets a new server deadline as for any
+ * arrival instead). The post pends the scheduler, so the job starts as
+ * soon as the handler returns if its deadline is the earliest. The time
+ * from the post to the first run is the start delay in the statistics of
+ * the task (process_rt_stats).
+ *
+ * Only non periodic processes that are not basic tasks may wait, and not
+ * while they hold a resource.
+ */
+
+#include "tick.h"
+
+/* What a process waits on, the first member of every object */
+typedef struct {
+	struct process_state * volatile waiter; /* the process waiting on the object, NULL if none */
+	volatile unsigned int posted; /* the time (ticks, low 32 bits) of the post that woke the waiter */
+	volatile int signalled; /* whether a post has woken the waiter */
+} rt_wait_t;
+
+typedef struct {
+	rt_wait_t wait;
+	unsigned char * buffer; /* capacity messages of size bytes */
+	unsigned int size; /* the bytes in a message */
+	unsigned int capacity; /* the number of messages the queue holds, a power of two */
+	volatile unsigned int head; /* the number of messages ever posted (written by the producer only) */
+	volatile unsigned int tail; /* the number of messages ever received (written by the consumer only) */
+} rt_queue_t;
+
+typedef struct {
+	rt_wait_t wait;
+	volatile unsigned int flags; /* the flags that are set */
+	unsigned int mask; /* the flags the waiter waits for */
+	int all; /* whether the waiter waits for all of mask rather than any of it */
+} rt_flags_t;
+
+/* Initialize an empty queue of capacity messages of size bytes in buffer
+ * (capacity * size bytes). Returns -1 if capacity is not a power of two,
+ * 0 otherwise.
+ */
+int rt_queue_init(rt_queue_t * queue, void * buffer, unsigned int size, unsigned int capacity);
+
+/* Post a copy of message, from the producer (an interrupt handler or a
+ * process). Returns -1 if the queue is full, 0 otherwise.
+ */
+int rt_queue_post(rt_queue_t * queue, const void * message);
+
+/* Receive the oldest message into message, waiting while the queue is
+ * empty. Returns -1 if the caller may not wait and the queue is empty, 0
+ * otherwise.
+ */
+int rt_queue_receive(rt_queue_t * queue, void * message);
+
+/* Receive the oldest message without waiting. Returns -1 if the queue is
+ * empty, 0 otherwise.
+ */
+int rt_queue_try_receive(rt_queue_t * queue, void * message);
+
+/* Initialize event flags with every flag clear */
+void rt_flags_init(rt_flags_t * flags);
+
+/* Set flags (from an interrupt handler or a process) */
+void rt_flags_set(rt_flags_t * flags, unsigned int set);
+
+/* Wait until any (all == 0) or all (all != 0) of the flags in mask are
+ * set, then clear the flags of mask that are set and return them in got.
+ * Returns -1 if the caller may not wait and the flags are not set, 0
+ * otherwise.
+ */
+int rt_flags_wait(rt_flags_t * flags, unsigned int mask, int all, unsigned int * got);
+
+/* Used by the objects above (implemented in process.c) */
+
+/* Blocks the calling process until wait is signalled. Call with
+ * interrupts disabled, right after seeing that there is nothing to take;
+ * returns with interrupts disabled. Returns -1 if the caller may not
+ * wait, 0 once it has been woken.
+ */
+int process_event_wait(rt_wait_t * wait);
+
+/* Wakes the process waiting on wait, if any. Safe from any interrupt
+ * handler.
+ */
+void process_event_post(rt_wait_t * wait);
+
+#endif
@@ -0,0 +1,156 @@
+#include <stdlib.h>
+#include "heap.h"
+
+/* Returns whether a must come out of the heap before b */
+
+static int heap_before(heap_node_t * a, heap_node_t * b) {
+	if (a->key != b->key) {
+		return a->key < b->key;
+	}
+	if (a->first != b->first) {
+		return a->first;
+	}
+	if (a->first) {
+		return (int) (b->seq - a->seq) < 0; //The latest heap_insert_first wins
+	}
+	return (int) (a->seq - b->seq) < 0; //Earlier insertion wins (wraps safely)
+}
+
+/* Links two heap roots together and returns the new root */
+
+static heap_node_t * heap_meld(heap_node_t * a, heap_node_t * b) {
+	if (heap_before(b, a)) {
+		heap_node_t * tmp = a;
+		a = b;
+		b = tmp;
+	}
+	b->sibling = a->child; //b becomes the first child of a
+	if (a->child != NULL) {
+		a->child->prev = b;
+	}
+	b->prev = a;
+	a->child = b;
+	return a;
+}
+
+/* Initializes an empty heap */
+
+void heap_init(heap_t * heap) {
+	heap->root = NULL;
+	heap->seq = 0;
+	heap->count = 0;
+}
+
+/* Links node, with its sequence number set, into the heap */
+
+static void heap_link(heap_t * heap, heap_node_t * node) {
+	node->child = NULL;
+	node->sibling = NULL;
+	node->prev = NULL;
+	if (heap->root == NULL) {
+		heap->root = node;
+	}
+	else {
+		heap->root = heap_meld(heap->root, node);
+	}
+	heap->count += 1;
+}
+
+/* Inserts node into the heap */
+
+void heap_insert(heap_t * heap, heap_node_t * node) {
+	node->seq = heap->seq++;
+	node->first = 0;
+	heap_link(heap, node);
+}
+
+/* Inserts node ahead of the nodes with the same key */
+
+void heap_insert_first(heap_t * heap, heap_node_t * node) {
+	node->seq = heap->seq++;
+	node->first = 1;
+	heap_link(heap, node);
+}
+
+/* Melds a list of siblings into one heap and returns its root, NULL for
+ * an empty list
+ */
+
+static heap_node_t * heap_merge_pairs(heap_node_t * child) {
+	heap_node_t * pairs = NULL;
+	heap_node_t * root = NULL;
+	//First pass: meld the children in pairs from left to right (the results are kept in reverse order)
+	while (child != NULL) {
+		heap_node_t * a = child;
+		heap_node_t * b = child->sibling;
+		a->prev = NULL;
+		if (b == NULL) {
+			a->sibling = pairs;
+			pairs = a;
+			break;
+		}
+		child = b->sibling;
+		b->prev = NULL;
+		a->sibling = NULL;
+		b->sibling = NULL;
+		a = heap_meld(a, b);
+		a->sibling = pairs;
+		pairs = a;
+	}
+	//Second pass: meld the pairs together from right to left
+	while (pairs != NULL) {
+		heap_node_t * next = pairs->sibling;
+		pairs->sibling = NULL;
+		if (root == NULL) {
+			root = pairs;
+		}
+		else {
+			root = heap_meld(root, pairs);
+		}
+		pairs = next;
+	}
+	return root;
+}
+
+/* Removes and returns the node with the smallest key */
+
+heap_node_t * heap_pop(heap_t * heap) {
+	heap_node_t * top = heap->root;
+	if (top == NULL) {
+		return NULL;
+	}
+	heap->root = heap_merge_pairs(top->child);
+	top->child = NULL;
+	heap->count -= 1;
+	return top;
+}
+
+/* Removes node from the heap: its subtree is cut out, and its children are
+ * melded together and back into the heap. The other nodes keep their
+ * sequence numbers, so equal keys still come out in insertion order.
+ */
+
+void heap_remove(heap_t * heap, heap_node_t * node) {
+	heap_node_t * rest;
+	if (node == heap->root) {
+		heap_pop(heap);
+		return;
+	}
+	if (node->prev->child == node) { //The first child of its parent
+		node->prev->child = node->sibling;
+	}
+	else {
+		node->prev->sibling = node->sibling;
+	}
+	if (node->sibling != NULL) {
+		node->sibling->prev = node->prev;
+	}
+	rest = heap_merge_pairs(node->child);
+	if (rest != NULL) {
+		heap->root = heap_meld(heap->root, rest);
+	}
+	node->child = NULL;
+	node->sibling = NULL;
+	node->prev = NULL;
+	heap->count -= 1;
+}
@@ -0,0 +1,49 @@
+#ifndef __HEAP_H__
+#define __HEAP_H__
+
+/* Intrusive pairing heap used for the EDF ready queue.
+ *
+ * A heap_node_t is embedded in the structure that is being queued, so
+ * inserting and removing never allocates. The node with the smallest key
+ * is at the root; nodes with equal keys come out in the order they were
+ * inserted (FIFO), which keeps arrival order between jobs that share a
+ * deadline, except that heap_insert_first puts a node ahead of them.
+ *
+ * insert and peek are O(1), pop and remove are O(log n) amortized.
+ */
+
+typedef struct heap_node {
+	unsigned long long key; /* the sort key (smallest first) */
+	unsigned int seq; /* insertion sequence number, used to break ties */
+	unsigned int first; /* set by heap_insert_first: ahead of the nodes with the same key */
+	struct heap_node * child; /* the first child */
+	struct heap_node * sibling; /* the next sibling */
+	struct heap_node * prev; /* the parent of a first child, the previous sibling of any other node, NULL for the root */
+} heap_node_t;
+
+typedef struct {
+	heap_node_t * root; /* the node with the smallest key, NULL if empty */
+	unsigned int seq; /* the sequence number given to the next insertion */
+	unsigned int count; /* the number of nodes in the heap */
+} heap_t;
+
+/* Initializes an empty heap */
+void heap_init(heap_t * heap);
+
+/* Inserts node into the heap (node->key must already be set) */
+void heap_insert(heap_t * heap, heap_node_t * node);
+
+/* Inserts node ahead of every node in the heap with the same key, even
+   those put there by an earlier heap_insert_first */
+void heap_insert_first(heap_t * heap, heap_node_t * node);
+
+/* Removes and returns the node with the smallest key, NULL if empty */
+heap_node_t * heap_pop(heap_t * heap);
+
+/* Removes node, which must be in the heap */
+void heap_remove(heap_t * heap, heap_node_t * node);
+
+/* Returns the node with the smallest key without removing it, NULL if empty */
+#define heap_peek(heap) ((heap)->root)
+
+#endif
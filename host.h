@@ -0,0 +1,70 @@
+#ifndef __HOST_H__
+#define __HOST_H__
+
+#include "tick.h"
+#include "rtconfig.h"
+
+/* Host simulation backend (3140_host.c).
+ *
+ * Builds the unchanged scheduler (process.c and its queues) on Linux with
+ * RT_HOST defined. Processes are ucontext coroutines and time is a
+ * simulated clock: it only advances while a process "computes" through
+ * host_run() or while the scheduler is idle. Every simulated tick runs the
+ * PIT1 path, and the PIT0 path runs every HOST_SLICE_TICKS ticks and right
+ * after a tick that pended it, so a scenario runs deterministically and
+ * far faster than real time.
+ *
+ * Build a scenario with:
+ *   gcc -DRT_HOST -o scenario scenario.c process.c 3140_host.c heap.c twheel.c tick.c pool.c instr.c admit.c trace.c
+ */
+
+#define HOST_SLICE_TICKS RT_SLICE_MS /* the PIT0 period */
+
+#define HOST_INTERRUPTS 16 /* the most simulated device interrupts pending at once */
+
+#ifndef HOST_STACK_BYTES
+#define HOST_STACK_BYTES (64 * 1024) /* the real host stack behind each simulated stack */
+#endif
+
+/* Simulates the calling process computing for ticks milliseconds */
+void host_run(unsigned int ticks);
+
+/* Simulates the calling process using words of its stack (on top of the
+ * saved context) by writing over the paint. Writing more words than the
+ * stack has overwrites its guard word, like an overflow would.
+ */
+void host_stack_use(unsigned int words);
+
+/* Frees the host stacks behind the stack pools (call after process_start
+ * has returned, e.g. before a thread of the multicore build exits)
+ */
+void host_free_stacks(void);
+
+/* Simulates a device interrupt: handler runs when the simulated clock
+ * reaches when, before the PIT1 path of that tick, like an interrupt
+ * handler of higher priority (it may post to event.h objects). Returns -1
+ * if HOST_INTERRUPTS are already pending, 0 otherwise.
+ */
+int host_interrupt_at(tick_t when, void (* handler)(void));
+
+/* Calls process_stop() when the simulated clock reaches when (0 = never) */
+void host_stop_at(tick_t when);
+
+/* Returns the simulated time */
+tick_t host_time(void);
+
+/* port_cycles() counts nanoseconds of host time, so RT_INSTRUMENT
+ * results from a host build are in ns rather than cycles.
+ */
+
+/* Scheduler statistics gathered by the backend since process_start */
+typedef struct {
+	unsigned long long selects; /* calls to process_select */
+	unsigned long long switches; /* selects that resumed a different process */
+	unsigned long long select_ns; /* wall clock time spent in process_select */
+	unsigned long long elided; /* PIT0 ticks that returned to the running process without calling process_select */
+} host_stats_t;
+
+extern RT_PERCORE host_stats_t host_stats;
+
+#endif
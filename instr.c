@@ -0,0 +1,85 @@
+#include "instr.h"
+
+#ifdef RT_INSTRUMENT
+
+#include "port.h"
+
+RT_PERCORE unsigned int (* instr_clock)(void) = port_cycles;
+
+RT_PERCORE volatile unsigned int instr_switch_entry;
+
+static RT_PERCORE instr_path_t instr_paths[INSTR_PATHS];
+
+static RT_PERCORE instr_sample_t instr_ring[INSTR_RING];
+
+static RT_PERCORE unsigned int instr_ring_head; /* the index the next sample is written to */
+
+static RT_PERCORE unsigned int instr_ring_count; /* the number of samples in the ring */
+
+/* Adds a sample to a path */
+
+void instr_record(unsigned int path, unsigned int cycles) {
+	instr_path_t * p = &instr_paths[path];
+	unsigned int bucket = 0;
+	if ((p->count == 0) || (cycles < p->min)) {
+		p->min = cycles;
+	}
+	if (cycles > p->max) {
+		p->max = cycles;
+	}
+	p->count += 1;
+	p->total += cycles;
+	while ((bucket < INSTR_BUCKETS - 1) && (cycles >> (bucket + 1))) {
+		bucket++;
+	}
+	p->histogram[bucket] += 1;
+	//The ring keeps the most recent samples, the oldest is overwritten when full
+	instr_ring[instr_ring_head].path = path;
+	instr_ring[instr_ring_head].cycles = cycles;
+	instr_ring_head = (instr_ring_head + 1) % INSTR_RING;
+	if (instr_ring_count < INSTR_RING) {
+		instr_ring_count += 1;
+	}
+}
+
+/* Records INSTR_SWITCH up to now */
+
+void instr_switch_done(void) {
+	instr_record(INSTR_SWITCH, instr_clock() - instr_switch_entry);
+}
+
+/* Clears every path and the ring */
+
+void instr_reset(void) {
+	unsigned int i, b;
+	for (i = 0; i < INSTR_PATHS; i++) {
+		instr_paths[i].count = 0;
+		instr_paths[i].min = 0;
+		instr_paths[i].max = 0;
+		instr_paths[i].total = 0;
+		for (b = 0; b < INSTR_BUCKETS; b++) {
+			instr_paths[i].histogram[b] = 0;
+		}
+	}
+	instr_ring_head = 0;
+	instr_ring_count = 0;
+}
+
+/* Returns the statistics of a path */
+
+const instr_path_t * instr_path(unsigned int path) {
+	return &instr_paths[path];
+}
+
+/* Takes the oldest sample off the ring */
+
+int instr_ring_read(instr_sample_t * sample) {
+	if (instr_ring_count == 0) {
+		return 0;
+	}
+	*sample = instr_ring[(instr_ring_head + INSTR_RING - instr_ring_count) % INSTR_RING];
+	instr_ring_count -= 1;
+	return 1;
+}
+
+#endif
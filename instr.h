@@ -0,0 +1,82 @@
+#ifndef __INSTR_H__
+#define __INSTR_H__
+
+/* Optional scheduler overhead instrumentation (build with RT_INSTRUMENT).
+ *
+ * The context switch, process_select, the queue operations and job
+ * release are timed with a cycle counter (DWT->CYCCNT on the board, see
+ * port_cycles). Every sample updates the min/mean/max and a log2 histogram
+ * of its path and is also kept in a fixed-size ring of recent samples.
+ * Read the results after process_start returns.
+ *
+ * Without RT_INSTRUMENT the INSTR_ macros expand to nothing, so the
+ * instrumented code is exactly the uninstrumented code.
+ */
+
+/* The timed paths */
+#define INSTR_SWITCH 0 /* scheduler entry (timer or SVC) to resuming the next process */
+#define INSTR_SELECT 1 /* process_select, not counting time asleep while idle */
+#define INSTR_INSERT 2 /* adding a process to the ready or not ready queue */
+#define INSTR_REMOVE 3 /* taking the earliest deadline process off the ready queue */
+#define INSTR_RELEASE 4 /* releasing the processes that have arrived */
+#define INSTR_PATHS 5
+
+#define INSTR_BUCKETS 16 /* bucket b counts samples of 2^b to 2^(b+1)-1 cycles, the last one everything above */
+
+#define INSTR_RING 256 /* the number of recent samples kept */
+
+#include "rtconfig.h"
+
+typedef struct {
+	unsigned int count; /* the number of samples */
+	unsigned int min; /* the fewest cycles taken */
+	unsigned int max; /* the most cycles taken */
+	unsigned long long total; /* the sum of all samples (mean = total / count) */
+	unsigned int histogram[INSTR_BUCKETS]; /* the number of samples in each bucket */
+} instr_path_t;
+
+typedef struct {
+	unsigned int path; /* INSTR_SWITCH ... INSTR_RELEASE */
+	unsigned int cycles; /* the cycles taken */
+} instr_sample_t;
+
+#ifdef RT_INSTRUMENT
+
+/* The clock samples are taken with, port_cycles unless replaced */
+extern RT_PERCORE unsigned int (* instr_clock)(void);
+
+/* Time stamp taken by the scheduler entry code (3140.s) for INSTR_SWITCH */
+extern RT_PERCORE volatile unsigned int instr_switch_entry;
+
+#define INSTR_START(var) unsigned int var = instr_clock()
+#define INSTR_PAUSE(var) ((var) = instr_clock() - (var)) /* var holds the cycles so far */
+#define INSTR_RESUME(var) ((var) = instr_clock() - (var))
+#define INSTR_STOP(path, var) instr_record((path), instr_clock() - (var))
+#define INSTR_RESET() instr_reset()
+
+/* Adds a sample to a path */
+void instr_record(unsigned int path, unsigned int cycles);
+
+/* Records INSTR_SWITCH up to now (called just before a process is resumed) */
+void instr_switch_done(void);
+
+/* Clears every path and the ring */
+void instr_reset(void);
+
+/* Returns the statistics of a path */
+const instr_path_t * instr_path(unsigned int path);
+
+/* Takes the oldest sample off the ring. Returns 0 if the ring is empty */
+int instr_ring_read(instr_sample_t * sample);
+
+#else
+
+#define INSTR_START(var)
+#define INSTR_PAUSE(var)
+#define INSTR_RESUME(var)
+#define INSTR_STOP(path, var)
+#define INSTR_RESET()
+
+#endif
+
+#endif
@@ -0,0 +1,161 @@
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include "multicore.h"
+#include "3140_concur.h"
+#include "admit.h"
+#include "host.h"
+
+#ifndef RT_MULTICORE
+#error "multicore.c needs the per-core scheduler state, build it with -DRT_MULTICORE"
+#endif
+
+typedef struct {
+	int core; /* the core the thread simulates */
+	core_task_t * tasks; /* every task */
+	int count; /* the number of tasks */
+	tick_t ticks; /* how long to run */
+	core_stats_t * stats; /* where the results of the core go */
+	int failed; /* whether a task could not be created */
+} core_thread_t;
+
+static RT_PERCORE int core_self; /* the core of the calling thread */
+
+static RT_PERCORE core_task_t * core_tasks[RT_MAX_PROCESSES]; /* the task of every process, by process id - 1 */
+
+/* Fills an admission test entry for a task */
+
+static void core_admit_task(const core_task_t * task, admit_task_t * entry) {
+	entry->wcet = tick_from_realtime(&task->wcet);
+	entry->deadline = tick_from_realtime(&task->deadline);
+	entry->period = tick_from_realtime(&task->period);
+}
+
+/* Orders admission test entries by decreasing density, which is the utilization for implicit deadlines */
+
+static unsigned long long core_density(const admit_task_t * entry) {
+	unsigned long long window = entry->deadline;
+	if ((entry->period != 0) && (entry->period < window)) {
+		window = entry->period;
+	}
+	return window ? (entry->wcet << 32) / window : ~0ULL;
+}
+
+static int core_compare(const void * a, const void * b) {
+	unsigned long long x = core_density(*(admit_task_t * const *) a), y = core_density(*(admit_task_t * const *) b);
+	return (x < y) - (x > y);
+}
+
+int core_partition(core_task_t * tasks, int count, int cores) {
+	admit_t sets[CORE_MAX];
+	admit_task_t * entries = malloc(count * sizeof(admit_task_t));
+	admit_task_t ** order = malloc(count * sizeof(admit_task_t *));
+	int i, core, unplaced = 0;
+	if (cores > CORE_MAX) {
+		cores = CORE_MAX;
+	}
+	for (core = 0; core < cores; core++) {
+		admit_init(&sets[core]);
+	}
+	for (i = 0; i < count; i++) {
+		core_admit_task(&tasks[i], &entries[i]);
+		order[i] = &entries[i];
+	}
+	qsort(order, count, sizeof(admit_task_t *), core_compare);
+	for (i = 0; i < count; i++) {
+		core_task_t * task = &tasks[order[i] - entries];
+		task->core = -1;
+		for (core = 0; core < cores; core++) {
+			if (admit_add(&sets[core], order[i]) == 0) {
+				task->core = core;
+				break;
+			}
+		}
+		if (task->core < 0) {
+			unplaced++;
+		}
+	}
+	free(order);
+	free(entries);
+	return unplaced;
+}
+
+/* Runs the tasks of one core */
+
+static void * core_main(void * arg) {
+	core_thread_t * thread = arg;
+	core_stats_t * stats = thread->stats;
+	struct timespec t0, t1;
+	int i, created = 0;
+	core_self = thread->core;
+	process_core_init();
+	for (i = 0; i < thread->count; i++) {
+		core_task_t * task = &thread->tasks[i];
+		admit_task_t entry;
+		rt_attr_t attr;
+		int result;
+		if (task->core != thread->core) {
+			continue;
+		}
+		rt_attr_init(&attr);
+		attr.wcet = task->wcet;
+		if ((task->period.sec == 0) && (task->period.msec == 0)) {
+			result = process_rt_create_attr(task->f, task->n, &task->start, &task->deadline, &attr);
+		}
+		else {
+			result = process_rt_periodic_attr(task->f, task->n, &task->start, &task->deadline, &task->period, &attr);
+		}
+		if (result != 0) {
+			thread->failed = 1;
+			continue;
+		}
+		core_tasks[created++] = task; //Process ids are given in creation order, from 1
+		core_admit_task(task, &entry);
+		stats->utilization += (entry.period ? (entry.wcet << 32) / entry.period : 0);
+	}
+	stats->tasks = created;
+	host_stop_at(thread->ticks);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	process_start();
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	host_stop_at(0);
+	stats->jobs_met = process_deadline_met;
+	stats->jobs_missed = process_deadline_miss;
+	stats->selects = host_stats.selects;
+	stats->switches = host_stats.switches;
+	stats->select_ns = host_stats.select_ns;
+	stats->wall_ms = (t1.tv_sec - t0.tv_sec) * 1e3 + (t1.tv_nsec - t0.tv_nsec) / 1e6;
+	host_free_stacks();
+	return NULL;
+}
+
+int core_run(core_task_t * tasks, int count, int cores, tick_t ticks, core_stats_t * stats) {
+	pthread_t threads[CORE_MAX];
+	core_thread_t args[CORE_MAX];
+	int core, failed = 0;
+	if (cores > CORE_MAX) {
+		cores = CORE_MAX;
+	}
+	for (core = 0; core < cores; core++) {
+		core_thread_t arg = {core, tasks, count, ticks, &stats[core], 0};
+		core_stats_t none = {0};
+		args[core] = arg;
+		stats[core] = none;
+		if (pthread_create(&threads[core], NULL, core_main, &args[core]) != 0) {
+			abort();
+		}
+	}
+	for (core = 0; core < cores; core++) {
+		pthread_join(threads[core], NULL);
+		failed |= args[core].failed;
+	}
+	return failed ? -1 : 0;
+}
+
+int core_id(void) {
+	return core_self;
+}
+
+core_task_t * core_task(void) {
+	return core_tasks[process_id() - 1];
+}
@@ -0,0 +1,68 @@
+#ifndef __MULTICORE_H__
+#define __MULTICORE_H__
+
+/* Partitioned EDF on several simulated cores (host only, build with
+ * RT_HOST and RT_MULTICORE and link with -pthread).
+ *
+ * Every core is a thread with its own copy of the scheduler state (see
+ * RT_PERCORE in rtconfig.h): its own current_process, ready and not ready
+ * queues, pools, simulated clock and statistics. A task is given to one
+ * core before the run and all of its jobs run there, so jobs never migrate
+ * and the cores share nothing while they run.
+ *
+ * core_partition() assigns the tasks first-fit decreasing: the tasks are
+ * taken in order of decreasing utilization (density for one-shot jobs and
+ * constrained deadlines) and each goes to the first core whose task set
+ * stays schedulable by the admission test of admit.h. core_run() then runs
+ * every core for the same simulated time.
+ *
+ * Build a scenario with:
+ *   gcc -DRT_HOST -DRT_MULTICORE -pthread -o scenario scenario.c multicore.c process.c 3140_host.c heap.c twheel.c tick.c pool.c instr.c admit.c trace.c
+ * The pool sizes in rtconfig.h are per core.
+ */
+
+#include "realtime.h"
+#include "tick.h"
+
+#define CORE_MAX 64 /* the most cores core_run simulates */
+
+typedef struct {
+	void (* f)(void); /* the function every job runs */
+	int n; /* the stack size in words */
+	realtime_t start; /* the release time of the first job */
+	realtime_t deadline; /* the deadline of a job relative to its release */
+	realtime_t period; /* the time between releases, 0 for a one-shot job */
+	realtime_t wcet; /* the worst-case execution time of a job */
+	int core; /* the core the task runs on, -1 if it fits on none (set by core_partition) */
+} core_task_t;
+
+/* What one core did in core_run */
+typedef struct {
+	unsigned int tasks; /* the tasks it ran */
+	unsigned long long utilization; /* the utilization of its tasks (32.32 fixed point, see ADMIT_ONE) */
+	int jobs_met; /* jobs that met their deadline */
+	int jobs_missed; /* jobs that missed their deadline */
+	unsigned long long selects; /* calls to process_select */
+	unsigned long long switches; /* selects that resumed a different process */
+	unsigned long long select_ns; /* wall clock time spent in process_select */
+	double wall_ms; /* wall clock time of the run */
+} core_stats_t;
+
+/* Assigns every task to one of cores cores (sets task->core). Returns the
+ * number of tasks that fit on no core, which are given -1.
+ */
+int core_partition(core_task_t * tasks, int count, int cores);
+
+/* Runs cores cores in parallel for ticks simulated milliseconds, each with
+ * the tasks assigned to it, and fills stats[0 ... cores-1]. Returns 0, or
+ * -1 if a task could not be created.
+ */
+int core_run(core_task_t * tasks, int count, int cores, tick_t ticks, core_stats_t * stats);
+
+/* Returns the core the caller runs on (0 outside core_run) */
+int core_id(void);
+
+/* Returns the task of the calling process */
+core_task_t * core_task(void);
+
+#endif
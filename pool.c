@@ -0,0 +1,88 @@
+#include <stdlib.h>
+#include "pool.h"
+
+/* Statically allocated stacks, one pool per size class (see rtconfig.h) */
+
+static RT_PERCORE unsigned int stack_memory_0[RT_STACK_COUNT_0][RT_STACK_WORDS_0];
+static RT_PERCORE unsigned int stack_memory_1[RT_STACK_COUNT_1][RT_STACK_WORDS_1];
+static RT_PERCORE unsigned int stack_memory_2[RT_STACK_COUNT_2][RT_STACK_WORDS_2];
+static RT_PERCORE unsigned int stack_memory_3[RT_STACK_COUNT_3][RT_STACK_WORDS_3];
+
+#ifdef RT_MULTICORE
+
+RT_PERCORE pool_t process_stack_pools[RT_STACK_CLASSES];
+
+/* Points the stack pools of the calling thread at its own stacks */
+
+void pool_core_init(void) {
+	pool_t pools[RT_STACK_CLASSES] = {
+		POOL_INIT(stack_memory_0, sizeof(stack_memory_0[0]), RT_STACK_COUNT_0),
+		POOL_INIT(stack_memory_1, sizeof(stack_memory_1[0]), RT_STACK_COUNT_1),
+		POOL_INIT(stack_memory_2, sizeof(stack_memory_2[0]), RT_STACK_COUNT_2),
+		POOL_INIT(stack_memory_3, sizeof(stack_memory_3[0]), RT_STACK_COUNT_3)
+	};
+	int i;
+	for (i = 0; i < RT_STACK_CLASSES; i++) {
+		process_stack_pools[i] = pools[i];
+	}
+}
+
+#else
+
+pool_t process_stack_pools[RT_STACK_CLASSES] = {
+	POOL_INIT(stack_memory_0, sizeof(stack_memory_0[0]), RT_STACK_COUNT_0),
+	POOL_INIT(stack_memory_1, sizeof(stack_memory_1[0]), RT_STACK_COUNT_1),
+	POOL_INIT(stack_memory_2, sizeof(stack_memory_2[0]), RT_STACK_COUNT_2),
+	POOL_INIT(stack_memory_3, sizeof(stack_memory_3[0]), RT_STACK_COUNT_3)
+};
+
+#endif
+
+/* Returns a block, NULL if the pool is used up */
+
+void * pool_alloc(pool_t * pool) {
+	void * block;
+	if (pool->free != NULL) {
+		block = pool->free;
+		pool->free = pool->free->next;
+	}
+	else if (pool->unused < pool->count) {
+		block = pool->memory + pool->unused * pool->block_size;
+		pool->unused += 1;
+	}
+	else {
+		return NULL;
+	}
+	pool->used += 1;
+	if (pool->used > pool->high_water) {
+		pool->high_water = pool->used;
+	}
+	return block;
+}
+
+/* Returns block to the pool */
+
+void pool_free(pool_t * pool, void * block) {
+	pool_block_t * free_block = (pool_block_t *) block;
+	free_block->next = pool->free;
+	pool->free = free_block;
+	pool->used -= 1;
+}
+
+/* Returns the block of the pool that contains address p */
+
+void * pool_block_of(pool_t * pool, void * p) {
+	unsigned char * address = (unsigned char *) p;
+	if ((address < pool->memory) || (address >= pool->memory + pool->count * pool->block_size)) {
+		return NULL;
+	}
+	return pool->memory + ((address - pool->memory) / pool->block_size) * pool->block_size;
+}
+
+/* Returns every block to the pool at once */
+
+void pool_reset(pool_t * pool) {
+	pool->unused = 0;
+	pool->free = NULL;
+	pool->used = 0;
+}
@@ -0,0 +1,56 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include "rtconfig.h"
+
+/* Fixed-size block pool with O(1) allocation and free.
+ *
+ * The blocks live in a statically allocated array. Blocks that have never
+ * been handed out are taken in order from the end of the used part of the
+ * array, and freed blocks are kept on a free list, so a pool needs no
+ * initialization code and never touches the heap.
+ *
+ * A pool has no locking of its own: a pool that an interrupt handler
+ * allocates from or frees to must only be used with interrupts disabled.
+ */
+
+typedef struct pool_block {
+	struct pool_block * next; /* the next free block */
+} pool_block_t;
+
+typedef struct {
+	unsigned char * memory; /* the blocks */
+	unsigned int block_size; /* the size of a block in bytes */
+	unsigned int count; /* the number of blocks */
+	unsigned int unused; /* blocks from this index on have never been handed out */
+	pool_block_t * free; /* blocks that have been freed */
+	unsigned int used; /* the number of blocks handed out */
+	unsigned int high_water; /* the most blocks ever handed out at once */
+} pool_t;
+
+/* Static initializer for a pool of count blocks of block_size bytes at memory */
+#define POOL_INIT(memory, block_size, count) { (unsigned char *) (memory), (block_size), (count), 0, NULL, 0, 0 }
+
+/* Returns a block, NULL if the pool is used up */
+void * pool_alloc(pool_t * pool);
+
+/* Returns block to the pool */
+void pool_free(pool_t * pool, void * block);
+
+/* Returns the block of the pool that contains address p, NULL if p is not in the pool */
+void * pool_block_of(pool_t * pool, void * p);
+
+/* Returns every block to the pool at once (the high-water mark is kept) */
+void pool_reset(pool_t * pool);
+
+/* The pools that process_stack_init takes stacks from, one per size class
+ * in rtconfig.h (smallest first)
+ */
+extern RT_PERCORE pool_t process_stack_pools[RT_STACK_CLASSES];
+
+#ifdef RT_MULTICORE
+/* Sets up the stack pools of the core the calling thread simulates (called by process_core_init) */
+void pool_core_init(void);
+#endif
+
+#endif
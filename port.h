@@ -0,0 +1,72 @@
+#ifndef __PORT_H__
+#define __PORT_H__
+
+#ifndef RT_HOST
+#include <MK64F12.h>
+#endif
+#include "tick.h"
+
+/* Hardware abstraction for the scheduler's time base.
+ *
+ * process.c only talks to the timers through these functions, so the
+ * same scheduler can run against the FRDM-K64F PIT (port_k64f.c) or the
+ * simulated clock of the host backend (3140_host.c, built with RT_HOST).
+ *
+ * By default PIT1 interrupts every tick and the current time is the
+ * number of those interrupts. When RT_TICKLESS is defined the current
+ * time is read from a free running counter instead, and PIT1 is only
+ * armed as a one-shot wakeup for the next event the scheduler is
+ * waiting for, so an idle system takes no timer interrupts.
+ */
+
+/* Interrupts are disabled while the scheduler queues are touched */
+#ifdef RT_HOST
+#define port_irq_disable() /* simulated interrupts only happen inside host_run() and port_idle() */
+#define port_irq_enable()
+#else
+#define port_irq_disable() __disable_irq()
+#define port_irq_enable() __enable_irq()
+#endif
+
+/* Disables interrupts and returns the interrupt mask from before, for
+ * code that may run with interrupts either enabled or disabled (interrupt
+ * handlers). Give the value back to port_irq_restore.
+ */
+unsigned int port_irq_save(void);
+
+/* Sets the interrupt mask back to what port_irq_save returned */
+void port_irq_restore(unsigned int state);
+
+/* Sets up the timers and interrupt priorities (called by process_start) */
+void port_timer_start(void);
+
+/* Returns the current time in ticks. Call with interrupts disabled. */
+tick_t port_time_now(void);
+
+/* Requests a timer interrupt at tick when (or as soon as possible if it
+ * has already passed). Only needed in tickless mode; in tick mode the
+ * periodic interrupt already wakes the scheduler every tick.
+ */
+void port_timer_wakeup(tick_t when);
+
+/* Sleeps until an interrupt is pending, then lets it run. Call and
+ * returns with interrupts disabled.
+ */
+void port_idle(void);
+
+/* Makes the scheduler run (PendSV on the board) as soon as the current
+ * interrupt returns
+ */
+void port_pend_resched(void);
+
+/* Returns a free running cycle count (wraps at 32 bits), used by the
+ * RT_INSTRUMENT instrumentation
+ */
+unsigned int port_cycles(void);
+
+/* Called by the port from the timer interrupt whenever time has advanced
+ * (implemented in process.c)
+ */
+void process_timer_interrupt(void);
+
+#endif
@@ -0,0 +1,142 @@
+#include <MK64F12.h>
+#include "port.h"
+#include "rtconfig.h"
+
+/*
+  PIT channel usage:
+
+  PIT0  time slicing timer, interrupts every RT_SLICE_MS ms (PIT0_IRQHandler in 3140.s,
+        which pends PendSV when process_select has to run)
+  PIT1  tick mode:     interrupts every 1 ms
+        tickless mode: one-shot wakeup, only armed while waiting for an event
+  PIT2  tickless mode: 1 ms prescaler for PIT3, no interrupt
+  PIT3  tickless mode: chained to PIT2, free running millisecond counter
+ */
+
+#define PIT_TCTRL_TEN 0x1 /* timer enable */
+#define PIT_TCTRL_TIE 0x2 /* timer interrupt enable */
+#define PIT_TCTRL_CHN 0x4 /* chain mode */
+
+#define PORT_CLOCKS_PER_TICK (SystemCoreClock / TICKS_PER_SEC)
+
+#ifdef RT_TICKLESS
+
+static tick_t port_ticks; /* the last extended reading of the free running counter */
+
+#else
+
+static volatile tick_t port_ticks; /* the number of PIT1 interrupts since port_timer_start */
+
+#endif
+
+/* Sets up the timers and interrupt priorities */
+
+void port_timer_start(void) {
+	SIM->SCGC6 |= SIM_SCGC6_PIT_MASK;
+	PIT_MCR = 00 << 0;
+	PIT_LDVAL0 = SystemCoreClock / 1000 * RT_SLICE_MS;
+	//Setting up priority for interrupts
+	NVIC_SetPriority(SVCall_IRQn, 1);
+	NVIC_SetPriority(PIT0_IRQn, 1);
+	NVIC_SetPriority(PIT1_IRQn, 0); //Highest priority
+	NVIC_SetPriority(PendSV_IRQn, (1 << __NVIC_PRIO_BITS) - 1); //Lowest priority, switches once every other handler has returned
+	//Processes that use the FPU get their FPU state saved, but only once a switch needs it (lazy stacking)
+	SCB->CPACR |= (0xF << 20); //Full access to CP10 and CP11
+	FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
+	port_ticks = 0;
+#ifdef RT_INSTRUMENT
+	//Starts the DWT cycle counter
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+#ifdef RT_TICKLESS
+	//PIT3 counts down once per millisecond from 0xFFFFFFFF, the elapsed count is its complement
+	PIT->CHANNEL[2].LDVAL = PORT_CLOCKS_PER_TICK - 1;
+	PIT->CHANNEL[3].LDVAL = 0xFFFFFFFF;
+	PIT->CHANNEL[3].TCTRL = PIT_TCTRL_CHN | PIT_TCTRL_TEN;
+	PIT->CHANNEL[2].TCTRL = PIT_TCTRL_TEN;
+	PIT->CHANNEL[1].TCTRL = 0; //Armed on demand by port_timer_wakeup
+#else
+	PIT_LDVAL1 = SystemCoreClock/1000;
+	PIT->CHANNEL[1].TCTRL |= PIT_TCTRL_TIE | PIT_TCTRL_TEN;
+#endif
+	//Enabling interrupts
+	NVIC_EnableIRQ(PIT0_IRQn);
+	NVIC_EnableIRQ(PIT1_IRQn);
+}
+
+/* Disables interrupts and returns PRIMASK from before */
+
+unsigned int port_irq_save(void) {
+	unsigned int state = __get_PRIMASK();
+	__disable_irq();
+	return state;
+}
+
+/* Sets PRIMASK back to what port_irq_save returned */
+
+void port_irq_restore(unsigned int state) {
+	__set_PRIMASK(state);
+}
+
+/* Returns the current time in ticks */
+
+tick_t port_time_now(void) {
+#ifdef RT_TICKLESS
+	port_ticks = tick_extend(port_ticks, 0xFFFFFFFF - PIT->CHANNEL[3].CVAL);
+#endif
+	return port_ticks;
+}
+
+/* Arms PIT1 to interrupt at tick when */
+
+void port_timer_wakeup(tick_t when) {
+#ifdef RT_TICKLESS
+	tick_t now = port_time_now();
+	tick_t delta = (when > now) ? when - now : 1;
+	if (delta > 0xFFFFFFFF / PORT_CLOCKS_PER_TICK) { //Longer than PIT1 can count, wakes up early and re-arms
+		delta = 0xFFFFFFFF / PORT_CLOCKS_PER_TICK;
+	}
+	PIT->CHANNEL[1].TCTRL = 0; //LDVAL only reloads when the timer is restarted
+	PIT_LDVAL1 = (unsigned int) delta * PORT_CLOCKS_PER_TICK - 1;
+	PIT_TFLG1 = 1 << 0;
+	PIT->CHANNEL[1].TCTRL = PIT_TCTRL_TIE | PIT_TCTRL_TEN;
+#else
+	(void) when;
+#endif
+}
+
+/* Pends PendSV, which runs the scheduler once no other handler is running */
+
+void port_pend_resched(void) {
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/* Returns the DWT cycle count */
+
+unsigned int port_cycles(void) {
+	return DWT->CYCCNT;
+}
+
+/* Sleeps until an interrupt is pending, then lets it run */
+
+void port_idle(void) {
+	__WFI(); //Wakes on a pending interrupt even though interrupts are masked
+	__enable_irq(); //Lets the interrupt handler run
+	__disable_irq();
+}
+
+/* Interrupt handler for PIT1 (the tick, or the tickless wakeup) */
+
+void PIT1_IRQHandler (void) {
+	NVIC_DisableIRQ(PIT1_IRQn);
+#ifdef RT_TICKLESS
+	PIT->CHANNEL[1].TCTRL = 0; //One-shot: stops until the next port_timer_wakeup
+#else
+	port_ticks += 1;
+#endif
+	PIT_TFLG1 = 1 << 0; //Resets the flag	
+	process_timer_interrupt();
+	NVIC_EnableIRQ(PIT1_IRQn);
+}
@@ -1,387 +1,2323 @@
-#include "3140_concur.h"
-#include <stdlib.h>
-#include <MK64F12.h>
-#include "realtime.h"
-
-/* Struct for the process */
-
-typedef struct process_state {
-	unsigned int stack_size;  /* the size of the stack */   
-	unsigned int * sp;  /* the stack pointer for the process */  
-	unsigned int * original_sp; /* the original stack pointer for the process */
-	unsigned int pc; /* the PC of the process */ 
-	struct process_state * next;   /* the next process */
-	int is_realtime; /* whether this is a real time process */
-	int is_periodic; /*whether this is a periodic process */
-	realtime_t arrival_time; /* the arrival time of the process */
-	realtime_t deadline; /* the deadline of the process */
-	realtime_t period; /* the period of the process */
-} process_t ;
-
-/* Helper functions (implementations at the bottom) */
-
-void add_process_queue(process_t * next_process);
-
-process_t * remove_process_queue(void);
-
-void add_not_ready_queue(process_t * next_process);
-
-process_t * remove_not_ready_queue(void);
-
-void add_ready_queue(process_t * next_process);
-
-process_t * remove_ready_queue(void);
-
-/* Global variables */
-
-process_t * current_process = NULL; /* The currently running process */
-
-process_t * process_queue = NULL; /* The queue for normal (non-real time) processes */
-
-process_t * ready_queue = NULL; /* The queue for all real time processes that are ready (sorted by deadline) */
-
-process_t * not_ready_queue = NULL; /* The queue for all real time processes that are not ready (sorted by arrival time) */
-
-int process_deadline_met; /* The number of processes that have terminated before their deadlines */
-
-int process_deadline_miss; /* The number of processes that have terminated after their deadlines */
-
-realtime_t current_time; /* The current time */
-
-/* Creates a non-real time process */
-
-int process_create(void (* f)(void), int n){
-	process_t * state = malloc(sizeof(process_t)); //Allocates memory for process
-	if (state == NULL) {
-		return -1;
-	}
-	unsigned int * stateOfProcess = process_stack_init(f, n); //State of process
-	if (stateOfProcess == NULL) {
-		free(state);
-		return -1;
-	}
-	else {
-		state->sp = stateOfProcess;
-		state->original_sp = stateOfProcess;
-		state->pc = (unsigned int) f;
-		state->next = NULL;
-		state->stack_size = n;
-		state->is_realtime = 0;
-		state->is_periodic = 0;
-		state->arrival_time.sec = 0;
-		state->arrival_time.msec = 0;
-		state->deadline.sec = 0;
-		state->deadline.msec = 0;
-		state->period.sec = 0;
-		state->period.msec = 0;
-		add_process_queue(state);
-		return NULL;
-	}
-}	
-
-/* Creates a real time process */
-
-int process_rt_create(void (* f) (void), int n, realtime_t * start, realtime_t * deadline) {
-	process_t * state = malloc(sizeof(process_t)); //Allocates memory for process
-	if (state == NULL) {
-		return -1;
-	}
-	unsigned int * stateOfProcess = process_stack_init(f, n); //State of process
-	if (stateOfProcess == NULL) {
-		free(state);
-		return -1;
-	}
-	else {
-		state->sp = stateOfProcess;
-		state->original_sp = stateOfProcess;
-		state->pc = (unsigned int) f;
-		state->next = NULL;
-		state->stack_size = n;
-		state->is_realtime = 1;
-		state->is_periodic = 0;
-		state->arrival_time = (* start); //start is in absolute time
-		//Converts deadline to absolute time because deadline is only relative to start
-		state->deadline.sec = start->sec + deadline->sec;
-		state->deadline.msec = start->msec + deadline->msec;
-		//Makes sure that msec is less than 1000 after converting the deadline
-		if(state->deadline.msec >= 1000) {
-			state->deadline.sec += state->deadline.msec / 1000;
-			state->deadline.msec = state->deadline.msec % 1000;
-		}	
-		state->period.sec = 0; 
-		state->period.msec = 0;
-		add_not_ready_queue(state);
-		return NULL;
-	}	
-}	
-
-/* Creates a real time periodic process */
-
-int process_rt_periodic(void (* f)(void), int n, realtime_t *start, realtime_t * deadline, realtime_t * period) {
-	process_t * state = malloc(sizeof(process_t)); //Allocates memory for process
-	if (state == NULL) {
-		return -1;
-	}
-	unsigned int * stateOfProcess = process_stack_init(f, n); //State of process
-	if (stateOfProcess == NULL) {
-		free(state);
-		return -1;
-	}
-	else {
-		state->sp = stateOfProcess;
-		state->original_sp = stateOfProcess;
-		state->pc = (unsigned int) f;
-		state->next = NULL;
-		state->stack_size = n;
-		state->is_realtime = 1;
-		state->is_periodic = 1;
-		state->arrival_time = (* start); //start is in absolute time
-		//Converts deadline to absolute time because deadline is only relative to start
-		state->deadline.msec = start->msec + deadline->msec;
-		state->deadline.sec = start->sec + deadline->sec;
-		//Makes sure that msec is less than 1000 after converting the deadline
-		if(state->deadline.msec >= 1000) {
-			state->deadline.sec += state->deadline.msec / 1000;
-			state->deadline.msec = state->deadline.msec % 1000;
-		}	
-		state->period = (* period);
-		add_not_ready_queue(state);
-		return NULL;
-	}	
-}	
-
-/* Reinitializes the stack and all the necessary contents in the stack (or the process will crash) */
-
-void process_stack_reinit(process_t * process) {
-	unsigned int * sp = process->original_sp;	//Original pointer to process stack (allocated in heap) 
-	sp[17] = 0x01000000; //xPSR
-  sp[16] = (unsigned int) process->pc; //PC
-	sp[15] = (unsigned int) process_terminated; //LR
-	sp[9] = 0xFFFFFFF9; //EXC_RETURN value, returns to thread mode
-	sp[0] = 0x3; //Enables scheduling timer and interrupt
-	process->sp = process->original_sp; 
-}	
-
-/* Starts up the concurrent execution */
-
-void process_start(void) {
-	SIM->SCGC6 |= SIM_SCGC6_PIT_MASK;
-	PIT_MCR = 00 << 0;
-	PIT_LDVAL0 = SystemCoreClock/100;
-	PIT_LDVAL1 = SystemCoreClock/1000;
-	//Setting up priority for interrupts
-	NVIC_SetPriority(SVCall_IRQn, 1);
-	NVIC_SetPriority(PIT0_IRQn, 1);
-	NVIC_SetPriority(PIT1_IRQn, 0); //Highest priority
-	PIT->CHANNEL[1].TCTRL |= 3;
-	//Enabling interrupts
-	NVIC_EnableIRQ(PIT0_IRQn);
-	NVIC_EnableIRQ(PIT1_IRQn);
-	process_begin();
-}	
-
-/* Selects which process to run next */
-
-unsigned int * process_select(unsigned int * cursp) {
-	while ((not_ready_queue != NULL) && (current_time.sec * 1000 + current_time.msec > not_ready_queue->arrival_time.sec * 1000 + not_ready_queue->arrival_time.msec)) { //Check whether unready processes in the queue become ready or not (current time is greater than start time: ready)
-		process_t * ready = remove_not_ready_queue();
-		add_ready_queue(ready);
-	}
-	if (cursp == NULL) { 
-		if (current_process != NULL) { //If there is a current process and it is done running
-			if (current_process->is_realtime) {
-				if (current_time.sec * 1000 + current_time.msec <= current_process->deadline.sec * 1000 + current_process->deadline.msec) { //Checks whether current process misses deadline
-					process_deadline_met += 1; //Updates number of processes that met the deadline
-				}
-				else {
-					process_deadline_miss += 1; //Updates number of processes that missed the deadline
-				}
-			}
-			if (current_process->is_periodic) { //If the current process is periodic
-				process_stack_reinit(current_process);
-				//Updates arrival time and deadline with the period
-				current_process->arrival_time.sec += current_process->period.sec;
-				current_process->arrival_time.msec += current_process->period.msec; 
-				current_process->deadline.sec += current_process->deadline.sec;
-				current_process->deadline.msec += current_process->deadline.msec;
-				//Makes sure that msec is less than 1000 for the current process's arrival time
-				if(current_process->arrival_time.msec >= 1000) {
-					current_process->arrival_time.sec += current_process->arrival_time.msec / 1000;
-					current_process->arrival_time.msec = current_process->arrival_time.msec % 1000;
-				}	
-				//Makes sure that msec is less than 1000 for the current process's deadline
-				if(current_process->deadline.msec >= 1000) {
-					current_process->deadline.sec += current_process->deadline.msec / 1000;
-					current_process->deadline.msec = current_process->deadline.msec % 1000;
-				}	
-				if (current_time.sec * 1000 + current_time.msec > current_process->arrival_time.sec * 1000 + current_process->arrival_time.msec) { //Check whether the current process becomes ready or not
-					add_ready_queue(current_process);
-				}	
-				else {
-					add_not_ready_queue(current_process);
-				}	
-			}
-			else {
-				process_stack_free(current_process->original_sp, current_process->stack_size); //Frees the process
-				free(current_process); //Frees the process as it is done running (for non-periodic processes only)
-			}
-		}
-	}
-	else { //The current process is not done running
-		current_process->sp = cursp;
-		if (current_process->is_realtime) {
-			add_ready_queue(current_process); //Adds to real time ready queue
-		}
-		else {
-			add_process_queue(current_process); //Adds to normal non-real time queue
-		}
-	}
-	if (ready_queue != NULL) { //If there are processes in the ready queue (real time processes)
-		current_process = remove_ready_queue();
-	}	
-	else if (process_queue != NULL) { //Else if there are processes in the process queue (non-real time processes)
-		current_process = remove_process_queue();
-	}	
-	else if (not_ready_queue != NULL) {//Else if there are processes in the not ready queue (real time processes)
-		__enable_irq(); //Enables interrupt or the process will never become ready
-		while (not_ready_queue->arrival_time.sec * 1000 + not_ready_queue->arrival_time.msec > current_time.sec * 1000 + current_time.msec) {} //Busy waits until the process becomes ready
-		__disable_irq(); //Disables interrupt		
-		current_process = remove_not_ready_queue();	
-	}
-	else {//There are no processes left
-		current_process = NULL;
-	}
-	if (current_process == NULL) { //If there is no current process running
-		return NULL;
-  }
-	else {
-		return current_process->sp;
-	}
-}
-
-/* Interrupt handler for PIT1 to generate interrupts every millisecond */
-
-void PIT1_IRQHandler (void) {
-	NVIC_DisableIRQ(PIT1_IRQn);
-	current_time.msec += 1;
-	if (current_time.msec >= 1000) {
-		current_time.sec += 1;
-		current_time.msec = 0;
-	}	
-	PIT_TFLG1 = 1 << 0; //Resets the flag	
-	NVIC_EnableIRQ(PIT1_IRQn);
-}
-			
-/* Helper functions */
-
-/* Adds process to the end of the process queue */
-
-void add_process_queue(process_t * next_process) {
-	if (process_queue == NULL) {
-		process_queue = next_process;
-		next_process->next = NULL;
-	}
-	else {
-		process_t * tmp = process_queue;
-		while (tmp->next != NULL) {
-			tmp = tmp->next;
-		}
-		tmp->next = next_process;
-		next_process->next = NULL;
-	}	
-}	
-
-/* Removes the first process in the process queue and return the first process of the queue after the removal */
-
-process_t * remove_process_queue(void) {
-	if (process_queue == NULL) {
-		return NULL;
-	}
-	else {
-		process_t * temp = process_queue;
-		process_queue = process_queue->next;
-		temp->next = NULL;
-		return temp;
-  }
-}	
-
-/* Adds process to the not ready queue (sorted by arrival time) */
-
-void add_not_ready_queue(process_t * next_process) {
-	if (not_ready_queue == NULL) {
-		not_ready_queue = next_process;
-		next_process->next = NULL;
-	}
-	else {
-		process_t * before = NULL;
-		process_t * after = not_ready_queue;
-		while ((after != NULL) && (next_process->arrival_time.sec * 1000 + next_process->arrival_time.msec >= after->arrival_time.sec * 1000 + after->arrival_time.msec)) {
-			before = after;
-			after = after->next;
-		}
-		next_process->next = after;
-		if (before != NULL) {
-			before->next = next_process;
-		}
-		else {
-			process_t * tmp = not_ready_queue;
-			not_ready_queue = next_process;
-			not_ready_queue->next = tmp;
-		}	
-	}	
-}	
-
-/* Removes the first process in the not ready queue and return the first process of the queue after the removal */
-
-process_t * remove_not_ready_queue(void) {
-	if (not_ready_queue == NULL) {
-		return NULL;
-	}
-	else {
-		process_t * temp = not_ready_queue;
-		not_ready_queue = not_ready_queue->next;
-		temp->next = NULL;
-		return temp;
-  }
-}
-
-/* Adds process to the ready queue (sorted by deadline) */
-
-void add_ready_queue(process_t * next_process) {
-	if (ready_queue == NULL) {
-		ready_queue = next_process;
-		next_process->next = NULL;
-	}
-	else {
-		process_t * before = NULL;
-		process_t * after = ready_queue;
-		while ((after != NULL) && (next_process->deadline.sec * 1000 + next_process->deadline.msec >= after->deadline.sec * 1000 + after->deadline.msec)) {
-			before = after;
-			after = after->next;
-		}
-		next_process->next = after;
-		if (before != NULL) {
-			before->next = next_process;
-		}
-		else {
-			process_t * tmp = ready_queue;
-			ready_queue = next_process;
-			ready_queue->next = tmp;
-		}	
-	}	
-}	
-
-/* Removes the first process in the ready queue and return the first process of the queue after the removal */
-
-process_t * remove_ready_queue(void) {
-	if (ready_queue == NULL) {
-		return NULL;
-	}
-	else {
-		process_t * temp = ready_queue;
-		ready_queue = ready_queue->next;
-		temp->next = NULL;
-		return temp;
-  }
-}
-
+#include "3140_concur.h"
+#include <stdlib.h>
+#include <stddef.h>
+#include "realtime.h"
+#include "tick.h"
+#include "port.h"
+#include "rtconfig.h"
+#include "pool.h"
+#include "instr.h"
+#include "heap.h"
+#include "twheel.h"
+#include "admit.h"
+#include "trace.h"
+#include "event.h"
+
+/* Running job statistics of a realtime task (see process_rt_stats) */
+
+typedef struct {
+	void (* f)(void); /* the function of the task, NULL if the entry is unused */
+	unsigned int jobs; /* the number of finished jobs */
+	unsigned int misses; /* the number of finished jobs that missed their deadline */
+	unsigned int preemptions; /* the number of times a job was switched out before finishing */
+	unsigned int skipped; /* the number of releases dropped by RT_OVERRUN_SKIP */
+	unsigned int overruns; /* the number of jobs that ran out of their execution budget */
+	unsigned int aborts; /* the number of jobs dropped at their deadline (RT_DEADLINE_FIRM) */
+	tick_t response_max; /* the longest arrival to finish time */
+	tick_t response_total; /* the sum of the arrival to finish times */
+	long long lateness_max; /* the latest finish minus deadline */
+	tick_t delay_min; /* the shortest arrival to first run time */
+	tick_t delay_max; /* the longest arrival to first run time */
+	unsigned int stack_max; /* the most stack words a process running the function has used (RT_STACK_PROFILE) */
+	unsigned int processes; /* the number of processes that use the entry */
+} task_stats_t;
+
+/* Struct for the process */
+
+typedef struct process_state {
+	unsigned int stack_size;  /* the size of the stack */   
+	unsigned int * sp;  /* the stack pointer for the process */  
+	unsigned int * original_sp; /* the original stack pointer for the process */
+	void (* pc)(void); /* the PC of the process (the function it runs) */ 
+	struct process_state * next;   /* the next process */
+	int is_realtime; /* whether this is a real time process */
+	int is_periodic; /*whether this is a periodic process */
+	tick_t arrival_time; /* the arrival time of the process (absolute) */
+	tick_t deadline; /* the deadline of the process (absolute) */
+	tick_t relative_deadline; /* the deadline of every job relative to its arrival time */
+	tick_t period; /* the period of the process */
+	int overrun; /* the overrun policy of a periodic process (RT_OVERRUN_...) */
+	int is_cbs; /* whether the process is served by a constant bandwidth server */
+	tick_t budget; /* the server budget per period (CBS only) */
+	tick_t remaining; /* the budget left before the server deadline moves (CBS only) */
+	heap_node_t ready_node; /* the node of the process in the ready queue */
+	twheel_node_t release_node; /* the node of the process in the not ready queue */
+	task_stats_t * stats; /* the statistics of the task, NULL if none are kept */
+	int job_started; /* whether the current job has run yet */
+	admit_task_t admit_node; /* the process in the admitted task set */
+	int admitted; /* whether the process went through admission control (it declared a worst-case execution time) */
+	int locks; /* the number of resources the process holds */
+	unsigned int id; /* the number of the process, in creation order from 1 */
+	int sleeping; /* whether the process waits in the not ready queue for wake_time (process_sleep_until) */
+	rt_wait_t * waiting; /* the object the process waits on (event.h), NULL if none */
+	tick_t wcet; /* the execution budget of a job, 0 for none */
+	tick_t used; /* the processor time the current job has had, up to the last switch */
+	int budget_action; /* what happens when a job runs out of budget (RT_BUDGET_...) */
+	void (* budget_hook)(void); /* called when a job runs out of budget, NULL for none */
+	int budget_spent; /* whether the current job has run out of budget (and the action has been taken) */
+	int demoted; /* whether the current job runs as a non real time process (RT_BUDGET_DEMOTE) */
+	int deadline_policy; /* what happens when a job reaches its deadline unfinished (RT_DEADLINE_...) */
+	void (* deadline_hook)(void); /* called when a job reaches its deadline unfinished, NULL for none */
+	int expired; /* whether the current job has passed its deadline unfinished */
+	twheel_node_t deadline_node; /* the node of the job in the deadline queue (firm and soft processes only) */
+	rt_handle_t handle; /* the handle of the process (process_handle) */
+	tick_t new_period; /* the period from the next release on (process_set_period), 0 for no change */
+	tick_t new_deadline; /* the relative deadline from the next release on (process_set_deadline), 0 for no change */
+	int suspending; /* whether the process is to be suspended at its next job boundary (process_suspend) */
+	int suspended; /* 0, or where the suspended process goes back to on process_resume (RESUME_...) */
+	int killed; /* whether the process is to be freed as soon as it holds no resource (process_kill) */
+	int shared; /* whether the jobs run to completion on the shared stack (a basic task) */
+	struct process_state * older_frame; /* the basic job whose frame is next above this one on the shared stack, while this one has a frame */
+	tick_t wake_time; /* the time a sleeping process becomes ready again */
+} process_t ;
+
+/* Gets the process that a ready queue node is embedded in */
+#define READY_PROCESS(node) ((process_t *) ((char *) (node) - offsetof(process_t, ready_node)))
+
+/* Gets the process that a not ready queue node is embedded in */
+#define RELEASE_PROCESS(node) ((process_t *) ((char *) (node) - offsetof(process_t, release_node)))
+
+/* Gets the process that a deadline queue node is embedded in */
+#define DEADLINE_PROCESS(node) ((process_t *) ((char *) (node) - offsetof(process_t, deadline_node)))
+
+/* Where a suspended process goes back to on process_resume */
+#define RESUME_READY 1 /* the ready queue or the process queue, it was ready or running */
+#define RESUME_RELEASE 2 /* the not ready queue, it waited for its arrival or wakeup time */
+#define RESUME_WAIT 3 /* the waiting list, it waited for an event */
+#define RESUME_PERIOD 4 /* the not ready queue for its first release that has not passed (periodic processes, between jobs) */
+
+/* A handle is the generation of its slot of the handle table above the index of the slot plus 1 */
+#define HANDLE_INDEX_BITS 16
+#define HANDLE_INDEX_MASK ((1u << HANDLE_INDEX_BITS) - 1)
+
+/* A slot of the handle table, one per process struct */
+typedef struct {
+	process_t * process; /* the process in the struct, NULL if the struct is free */
+	unsigned int generation; /* counts the processes the struct has held, so that old handles stop matching */
+} handle_slot_t;
+
+/* A relative deadline that basic tasks have, one link of the deepest preemption chain on the shared stack */
+typedef struct {
+	tick_t deadline; /* the relative deadline */
+	unsigned int words; /* the largest stack of a task with it, with the saved context */
+	unsigned int tasks; /* the tasks with it (a task with a new deadline pending counts at both) */
+} shared_level_t;
+
+/* Helper functions (implementations at the bottom) */
+
+void add_process_queue(process_t * next_process);
+
+process_t * remove_process_queue(void);
+
+void add_not_ready_queue(process_t * next_process);
+
+void release_not_ready_queue(void);
+
+void update_current_time(void);
+
+void discard_processes(void);
+
+void add_ready_queue(process_t * next_process);
+
+process_t * remove_ready_queue(void);
+
+task_stats_t * find_task_stats(void (* f)(void));
+
+void record_job_start(process_t * process);
+
+void record_job_end(process_t * process);
+
+void rearm_periodic(process_t * process);
+
+void cbs_arrive(process_t * process);
+
+void cbs_charge(process_t * process);
+
+int admit_process(process_t * process, tick_t wcet, tick_t deadline, tick_t period);
+
+void dismiss_process(process_t * process);
+
+process_t * alloc_process(void);
+
+unsigned int * alloc_stack(void (* f)(void), int n);
+
+void unalloc_process(process_t * process);
+
+int keeps_running(process_t * process);
+
+void arm_wakeup(void);
+
+int sleep_process(tick_t wake, int from_now);
+
+void stack_overflow(process_t * process);
+
+void free_process(process_t * process);
+
+int srp_eligible(process_t * process);
+
+void block_ready_queue(void);
+
+void unblock_processes(void);
+
+void unlock_resource(rt_resource_t * resource);
+
+void release_resources(process_t * process);
+
+void finish_job(process_t * process);
+
+void wake_waiters(void);
+
+void next_job(process_t * process);
+
+int runs_realtime(process_t * process);
+
+int budget_exhausted(process_t * process, tick_t used);
+
+int budget_overrun(process_t * process);
+
+void drop_job(process_t * process);
+
+void arm_deadline(process_t * process);
+
+void disarm_deadline(process_t * process);
+
+int expire_deadlines(process_t * preempted, int resume);
+
+int abort_due(process_t * process);
+
+void abort_job(process_t * process);
+
+void unqueue_process(process_t * process);
+
+int unlink_process(process_t ** list, process_t * process);
+
+void remove_ready_process(process_t * process);
+
+void release_job(process_t * process);
+
+tick_t release_delay(process_t * process);
+
+rt_handle_t handle_create(process_t * process);
+
+void handle_free(process_t * process);
+
+process_t * find_process(rt_handle_t handle);
+
+int retime_process(rt_handle_t handle, tick_t deadline, tick_t period);
+
+int retime_valid(process_t * process, tick_t deadline, tick_t period);
+
+int admit_test(admit_task_t * task, rt_handle_t replaces);
+
+admit_task_t * admitted_node(rt_handle_t handle);
+
+int admit_snapshot_copy(admit_task_t * skip);
+
+int suspend_due(process_t * process);
+
+int stop_due(process_t * process);
+
+void park_process(process_t * process, int where);
+
+void resume_process(process_t * process);
+
+void kill_process(process_t * process);
+
+unsigned int * shared_stack_join(int n, tick_t deadline, const rt_attr_t * attr);
+
+unsigned int shared_stack_depth(int n, tick_t deadline);
+
+shared_level_t * shared_level_find(tick_t deadline);
+
+void shared_level_join(int n, tick_t deadline);
+
+void shared_level_leave(tick_t deadline);
+
+void drop_unfit_jobs(void);
+
+void shared_frame_start(process_t * process);
+
+void shared_frame_end(process_t * process);
+
+/* The system ceiling while no resource is locked */
+#define SRP_NO_CEILING (~(tick_t) 0)
+
+/* The admitted tasks admit_snapshot_copy copies with interrupts disabled at a time */
+#define ADMIT_SNAPSHOT_CHUNK 8
+
+/* Global variables */
+
+RT_PERCORE process_t * current_process = NULL; /* The currently running process */
+
+RT_PERCORE process_t * process_queue = NULL; /* The queue for normal (non-real time) processes */
+
+RT_PERCORE heap_t ready_queue; /* The heap for all real time processes that are ready (earliest deadline first) */
+
+RT_PERCORE twheel_t not_ready_queue; /* The timing wheel for all real time processes that are not ready (keyed by arrival time) */
+
+RT_PERCORE twheel_t deadline_queue; /* The timing wheel of the pending jobs of firm and soft processes (keyed by the tick after the deadline) */
+
+static RT_PERCORE process_t process_memory[RT_MAX_PROCESSES]; /* Statically allocated process structs */
+
+#ifdef RT_MULTICORE
+RT_PERCORE pool_t process_pool; /* The pool that processes are allocated from (set up by process_core_init) */
+#else
+pool_t process_pool = POOL_INIT(process_memory, sizeof(process_t), RT_MAX_PROCESSES); /* The pool that processes are allocated from */
+#endif
+
+static RT_PERCORE task_stats_t task_stats[RT_MAX_TASK_STATS]; /* Job statistics of the realtime tasks, by function */
+
+static RT_PERCORE handle_slot_t handle_table[RT_MAX_PROCESSES]; /* The handle of the process in each struct of process_memory, by index */
+
+RT_PERCORE int process_deadline_met; /* The number of processes that have terminated before their deadlines */
+
+RT_PERCORE int process_deadline_miss; /* The number of processes that have terminated after their deadlines */
+
+RT_PERCORE int process_stack_overflows; /* The number of processes stopped because they ran past the bottom of their stack */
+
+RT_PERCORE realtime_t current_time; /* The current time (API copy of current_tick) */
+
+RT_PERCORE tick_t current_tick; /* The current time in ticks, used for all scheduling decisions */
+
+RT_PERCORE tick_t dispatch_tick; /* The time current_process was last switched in, for charging CBS and execution budgets */
+
+RT_PERCORE admit_t admitted_tasks; /* The processes that passed admission control */
+
+static RT_PERCORE admit_task_t admit_snapshot_tasks[RT_MAX_PROCESSES]; /* A copy of admitted_tasks that the demand test runs on with interrupts enabled */
+
+static RT_PERCORE admit_t admit_snapshot; /* The set of admit_snapshot_tasks */
+
+static RT_PERCORE int admit_snapshot_busy = 0; /* Set while an admission test uses the snapshot */
+
+RT_PERCORE tick_t next_release = TWHEEL_NEVER; /* The earliest tick at which the not ready queue may release a process */
+
+RT_PERCORE tick_t next_deadline = TWHEEL_NEVER; /* The earliest tick at which a job in the deadline queue may expire */
+
+RT_PERCORE volatile int process_resched = 1; /* Whether the next PIT0 tick has to call process_select (3140.s skips it otherwise) */
+
+RT_PERCORE rt_resource_t * locked_resources = NULL; /* The locked resources, the last one locked first */
+
+RT_PERCORE tick_t system_ceiling = SRP_NO_CEILING; /* The shortest ceiling of the locked resources (the SRP system ceiling) */
+
+RT_PERCORE process_t * blocked_processes = NULL; /* Ready real time processes that the system ceiling keeps from starting */
+
+RT_PERCORE process_t * waiting_processes = NULL; /* Processes waiting on a queue or event flags (event.h) */
+
+RT_PERCORE volatile int process_events = 0; /* Set when a post has woken a waiting process */
+
+RT_PERCORE int suspended_processes = 0; /* The number of suspended processes (process_suspend) */
+
+RT_PERCORE unsigned int * shared_stack = NULL; /* The stack that the basic tasks share (from process_stack_init), NULL while there are none */
+
+RT_PERCORE process_t * shared_frames = NULL; /* The basic job that started on the shared stack last and has not finished, the others linked through older_frame */
+
+RT_PERCORE int shared_tasks = 0; /* The number of basic tasks */
+
+static RT_PERCORE shared_level_t shared_levels[2 * RT_MAX_PROCESSES]; /* The relative deadlines of the basic tasks, in no order */
+
+RT_PERCORE unsigned int shared_level_count = 0; /* The entries of shared_levels in use */
+
+RT_PERCORE unsigned int shared_depth = 0; /* The sum of the words of shared_levels: the deepest chain */
+
+RT_PERCORE unsigned int next_process_id = 1; /* The id of the next process created (numbering starts over after each run) */
+
+RT_PERCORE int process_stopping = 0; /* Set by process_stop, ends the concurrent execution at the next scheduling point */
+
+#ifdef RT_MULTICORE
+
+/* Sets up the scheduler of the core the calling thread simulates */
+
+void process_core_init(void) {
+	pool_t pool = POOL_INIT(process_memory, sizeof(process_t), RT_MAX_PROCESSES);
+	process_pool = pool;
+	pool_core_init();
+}
+
+#endif
+
+/* Sets up a new process running f on the stack of n words at sp with the
+ * defaults of a non real time process. The create functions then set what
+ * differs for their kind.
+ */
+
+static void init_process(process_t * state, void (* f)(void), int n, unsigned int * sp) {
+	state->sp = sp;
+	state->original_sp = sp;
+	state->pc = f;
+	state->next = NULL;
+	state->stack_size = n;
+	state->is_realtime = 0;
+	state->is_periodic = 0;
+	state->arrival_time = 0;
+	state->deadline = 0;
+	state->relative_deadline = 0;
+	state->period = 0;
+	state->overrun = RT_OVERRUN_DEFAULT;
+	state->is_cbs = 0;
+	state->stats = NULL;
+	state->job_started = 0;
+	state->locks = 0;
+	state->id = next_process_id++;
+	state->handle = handle_create(state);
+	state->new_period = 0;
+	state->new_deadline = 0;
+	state->suspending = 0;
+	state->suspended = 0;
+	state->killed = 0;
+	state->shared = 0;
+	state->older_frame = NULL;
+	state->release_node.list = NULL;
+	state->sleeping = 0;
+	state->waiting = NULL;
+	state->used = 0;
+	state->budget_spent = 0;
+	state->demoted = 0;
+	state->wcet = 0;
+	state->budget_action = RT_BUDGET_NONE;
+	state->budget_hook = NULL;
+	state->deadline_policy = RT_DEADLINE_HARD;
+	state->deadline_hook = NULL;
+	state->expired = 0;
+	state->deadline_node.list = NULL;
+}
+
+/* Sets the attributes that real time processes take from attr, and hands out the handle */
+
+static void init_attr(process_t * state, const rt_attr_t * attr) {
+	state->wcet = tick_from_realtime(&attr->wcet);
+	state->budget_action = attr->budget_action;
+	state->budget_hook = attr->budget_hook;
+	state->deadline_policy = attr->deadline_policy;
+	state->deadline_hook = attr->deadline_hook;
+	state->shared = attr->basic;
+	if (attr->handle != NULL) {
+		*attr->handle = state->handle;
+	}
+}
+
+/* Creates a non-real time process */
+
+int process_create(void (* f)(void), int n){
+	process_t * state = alloc_process(); //Allocates memory for process
+	if (state == NULL) {
+		return -1;
+	}
+	unsigned int * stateOfProcess = alloc_stack(f, n); //State of process
+	if (stateOfProcess == NULL) {
+		unalloc_process(state);
+		return -1;
+	}
+	init_process(state, f, n, stateOfProcess);
+#if RT_STACK_PROFILE
+	state->stats = find_task_stats(f); //Only the stack use is kept for non real time processes
+#endif
+	port_irq_disable(); //The timer interrupt and process_select use the queues too
+	add_process_queue(state);
+	port_irq_enable();
+	return 0;
+}	
+
+/* Creates a real time process */
+
+int process_rt_create(void (* f) (void), int n, realtime_t * start, realtime_t * deadline) {
+	return process_rt_create_attr(f, n, start, deadline, NULL);
+}
+
+/* Creates a real time process with attributes */
+
+int process_rt_create_attr(void (* f) (void), int n, realtime_t * start, realtime_t * deadline, const rt_attr_t * attr) {
+	rt_attr_t defaults;
+	if (attr == NULL) {
+		rt_attr_init(&defaults);
+		attr = &defaults;
+	}
+	process_t * state = alloc_process(); //Allocates memory for process
+	if (state == NULL) {
+		return -1;
+	}
+	if (admit_process(state, tick_from_realtime(&attr->wcet), tick_from_realtime(deadline), 0) != 0) { //The task set would not be schedulable
+		unalloc_process(state);
+		return -2;
+	}
+	unsigned int * stateOfProcess = attr->basic ? shared_stack_join(n, tick_from_realtime(deadline), attr) : alloc_stack(f, n); //State of process
+	if (stateOfProcess == NULL) {
+		unalloc_process(state);
+		return -1;
+	}
+	init_process(state, f, n, stateOfProcess);
+	state->is_realtime = 1;
+	state->arrival_time = tick_from_realtime(start); //start is in absolute time
+	state->relative_deadline = tick_from_realtime(deadline);
+	state->deadline = state->arrival_time + state->relative_deadline; //Converts deadline to absolute time because deadline is only relative to start
+	state->stats = find_task_stats(f);
+	init_attr(state, attr);
+	port_irq_disable(); //The timer interrupt and process_select use the queues too
+	add_not_ready_queue(state);
+	port_irq_enable();
+	return 0;
+}	
+
+/* Creates a process served by a constant bandwidth server */
+
+int process_rt_cbs(void (* f)(void), int n, realtime_t * start, realtime_t * budget, realtime_t * period) {
+	tick_t server_budget = tick_from_realtime(budget);
+	tick_t server_period = tick_from_realtime(period);
+	if ((server_budget == 0) || (server_budget > server_period)) {
+		return -1;
+	}
+	process_t * state = alloc_process(); //Allocates memory for process
+	if (state == NULL) {
+		return -1;
+	}
+	if (admit_process(state, server_budget, server_period, server_period) != 0) { //The task set would not be schedulable
+		unalloc_process(state);
+		return -2;
+	}
+	unsigned int * stateOfProcess = alloc_stack(f, n); //State of process
+	if (stateOfProcess == NULL) {
+		unalloc_process(state);
+		return -1;
+	}
+	init_process(state, f, n, stateOfProcess);
+	state->is_realtime = 1;
+	state->arrival_time = tick_from_realtime(start); //start is in absolute time
+	state->deadline = 0; //Assigned by cbs_arrive when the process arrives
+	state->relative_deadline = server_period;
+	state->period = server_period;
+	state->is_cbs = 1;
+	state->budget = server_budget;
+	state->remaining = 0;
+	state->stats = find_task_stats(f);
+	port_irq_disable(); //The timer interrupt and process_select use the queues too
+	add_not_ready_queue(state);
+	port_irq_enable();
+	return 0;
+}
+
+/* Sets every process attribute to its default */
+
+void rt_attr_init(rt_attr_t * attr) {
+	attr->overrun = RT_OVERRUN_DEFAULT;
+	attr->wcet.sec = 0;
+	attr->wcet.msec = 0;
+	attr->budget_action = RT_BUDGET_DEFAULT;
+	attr->budget_hook = NULL;
+	attr->deadline_policy = RT_DEADLINE_DEFAULT;
+	attr->deadline_hook = NULL;
+	attr->handle = NULL;
+	attr->basic = 0;
+}
+
+/* Creates a real time periodic process */
+
+int process_rt_periodic(void (* f)(void), int n, realtime_t *start, realtime_t * deadline, realtime_t * period) {
+	return process_rt_periodic_attr(f, n, start, deadline, period, NULL);
+}
+
+/* Creates a real time periodic process with attributes */
+
+int process_rt_periodic_attr(void (* f)(void), int n, realtime_t *start, realtime_t * deadline, realtime_t * period,
+		const rt_attr_t * attr) {
+	rt_attr_t defaults;
+	if (attr == NULL) {
+		rt_attr_init(&defaults);
+		attr = &defaults;
+	}
+	process_t * state = alloc_process(); //Allocates memory for process
+	if (state == NULL) {
+		return -1;
+	}
+	if (admit_process(state, tick_from_realtime(&attr->wcet), tick_from_realtime(deadline), tick_from_realtime(period)) != 0) { //The task set would not be schedulable
+		unalloc_process(state);
+		return -2;
+	}
+	unsigned int * stateOfProcess = attr->basic ? shared_stack_join(n, tick_from_realtime(deadline), attr) : alloc_stack(f, n); //State of process
+	if (stateOfProcess == NULL) {
+		unalloc_process(state);
+		return -1;
+	}
+	init_process(state, f, n, stateOfProcess);
+	state->is_realtime = 1;
+	state->is_periodic = 1;
+	state->arrival_time = tick_from_realtime(start); //start is in absolute time
+	state->relative_deadline = tick_from_realtime(deadline);
+	state->deadline = state->arrival_time + state->relative_deadline; //Converts deadline to absolute time because deadline is only relative to start
+	state->period = tick_from_realtime(period);
+	state->overrun = attr->overrun;
+	state->stats = find_task_stats(f);
+	init_attr(state, attr);
+	port_irq_disable(); //The timer interrupt and process_select use the queues too
+	add_not_ready_queue(state);
+	port_irq_enable();
+	return 0;
+}	
+
+/* Reinitializes the stack and all the necessary contents in the stack (or the process will crash) */
+
+void process_stack_reinit(process_t * process) {
+	process->sp = process_stack_reset(process->original_sp, process->pc);
+}	
+
+/* Gets the usage of a memory pool (0 is the process pool, 1 to RT_STACK_CLASSES are the stack size classes) */
+
+int process_pool_stats(int pool, pool_stats_t * stats) {
+	pool_t * p;
+	if (pool == 0) {
+		p = &process_pool;
+	}
+	else if ((pool > 0) && (pool <= RT_STACK_CLASSES)) {
+		p = &process_stack_pools[pool - 1];
+	}
+	else {
+		return -1;
+	}
+	port_irq_disable();
+	stats->block_size = p->block_size;
+	stats->total = p->count;
+	stats->used = p->used;
+	stats->high_water = p->high_water;
+	port_irq_enable();
+	return 0;
+}
+
+/* Gets the stack high-water mark of the calling process */
+
+unsigned int process_stack_high_water(void) {
+	return process_stack_used(current_process->original_sp);
+}
+
+/* Gets the most stack any process running f has used */
+
+int process_stack_profile(void (* f)(void), unsigned int * n) {
+	int i;
+	for (i = 0; i < RT_MAX_TASK_STATS; i++) {
+		if (task_stats[i].f == f) {
+			port_irq_disable();
+			*n = task_stats[i].stack_max;
+			port_irq_enable();
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/* Gets the job statistics of the realtime task(s) running f */
+
+int process_rt_stats(void (* f)(void), process_rt_stats_t * stats) {
+	int i;
+	for (i = 0; i < RT_MAX_TASK_STATS; i++) {
+		if (task_stats[i].f == f) {
+			task_stats_t * t = &task_stats[i];
+			port_irq_disable();
+			stats->jobs = t->jobs;
+			stats->misses = t->misses;
+			stats->response_max = t->response_max;
+			stats->response_avg = (t->jobs == 0) ? 0 : t->response_total / t->jobs;
+			stats->lateness_max = t->lateness_max;
+			stats->start_delay_max = t->delay_max;
+			stats->jitter = (t->delay_max > t->delay_min) ? t->delay_max - t->delay_min : 0;
+			stats->preemptions = t->preemptions;
+			stats->skipped = t->skipped;
+			stats->overruns = t->overruns;
+			stats->aborts = t->aborts;
+			port_irq_enable();
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/* Clears the job statistics of every task, and gives up the entries of the functions that no process runs any more */
+
+void process_rt_stats_reset(void) {
+	int i;
+	port_irq_disable();
+	for (i = 0; i < RT_MAX_TASK_STATS; i++) {
+		task_stats[i].jobs = 0;
+		task_stats[i].misses = 0;
+		task_stats[i].preemptions = 0;
+		task_stats[i].skipped = 0;
+		task_stats[i].overruns = 0;
+		task_stats[i].aborts = 0;
+		task_stats[i].response_max = 0;
+		task_stats[i].response_total = 0;
+		task_stats[i].lateness_max = 0;
+		task_stats[i].delay_min = ~(tick_t) 0;
+		task_stats[i].delay_max = 0;
+		task_stats[i].stack_max = 0;
+		if (task_stats[i].processes == 0) {
+			task_stats[i].f = NULL;
+		}
+	}
+	port_irq_enable();
+}
+
+/* Initializes a free resource */
+
+void rt_resource_init(rt_resource_t * resource, realtime_t * ceiling) {
+	resource->ceiling = tick_from_realtime(ceiling);
+	resource->ceiling_below = SRP_NO_CEILING;
+	resource->owner = NULL;
+	resource->below = NULL;
+}
+
+/* Locks a resource, raising the system ceiling to its ceiling */
+
+int process_rt_lock(rt_resource_t * resource) {
+	port_irq_disable();
+	if ((resource->owner != NULL) || (current_process->is_realtime && (current_process->relative_deadline < resource->ceiling))) {
+		port_irq_enable();
+		return -1;
+	}
+	resource->owner = current_process;
+	resource->ceiling_below = system_ceiling;
+	resource->below = locked_resources;
+	locked_resources = resource;
+	if (resource->ceiling < system_ceiling) {
+		system_ceiling = resource->ceiling;
+	}
+	current_process->locks += 1;
+	port_irq_enable();
+	return 0;
+}
+
+/* Unlocks the last resource the caller locked, and switches to a process it held back if that one is due first */
+
+int process_rt_unlock(rt_resource_t * resource) {
+	heap_node_t * first;
+	port_irq_disable();
+	if ((resource != locked_resources) || (resource->owner != current_process)) {
+		port_irq_enable();
+		return -1;
+	}
+	unlock_resource(resource);
+	first = heap_peek(&ready_queue);
+	if (((first != NULL) && (!runs_realtime(current_process) || (first->key < current_process->deadline)))
+			|| stop_due(current_process)) { //Or it was dropped, suspended or killed in the critical section and goes now
+		process_blocked();
+	}
+	port_irq_enable();
+	return 0;
+}
+
+/* Blocks the caller until the current time reaches when. The processor
+ * goes to other ready processes, or idles, in the meantime.
+ */
+
+int process_sleep_until(realtime_t * when) {
+	return sleep_process(tick_from_realtime(when), 0);
+}
+
+/* Blocks the caller for time from now */
+
+int process_sleep_for(realtime_t * time) {
+	return sleep_process(tick_from_realtime(time), 1);
+}
+
+/* Blocks the caller until tick wake, or for wake ticks from now if
+ * from_now is set (the time is read with interrupts disabled, which
+ * port_time_now needs)
+ */
+
+int sleep_process(tick_t wake, int from_now) {
+	port_irq_disable();
+	if (from_now) {
+		wake += port_time_now();
+	}
+	if ((current_process->locks > 0) || current_process->shared) { //Under SRP a job may not wait while it holds resources, and a basic job never waits
+		port_irq_enable();
+		return -1;
+	}
+	if (wake > port_time_now()) {
+		current_process->sleeping = 1;
+		current_process->wake_time = wake;
+		process_blocked(); //process_select puts it in the not ready queue
+	}
+	port_irq_enable();
+	return 0;
+}
+
+/* Blocks the caller until a post to the object it waits on */
+
+int process_event_wait(rt_wait_t * wait) {
+	if ((current_process->locks > 0) || current_process->is_periodic || current_process->shared) { //Periodic processes are released by time, basic jobs never wait
+		return -1;
+	}
+	wait->signalled = 0;
+	wait->waiter = current_process;
+	current_process->waiting = wait;
+	process_blocked(); //process_select puts it in the waiting list
+	port_irq_disable();
+	return 0;
+}
+
+/* Wakes the waiter of an object, process_select makes it ready */
+
+void process_event_post(rt_wait_t * wait) {
+	if ((wait->waiter != NULL) && !wait->signalled) {
+		unsigned int irq = port_irq_save(); //port_time_now may not be interrupted (PIT1 updates the clock), and the caller may already have interrupts disabled
+		wait->posted = (unsigned int) port_time_now();
+		port_irq_restore(irq);
+		wait->signalled = 1;
+		process_events = 1;
+		process_resched = 1;
+		port_pend_resched(); //A job that the post releases may be due first
+	}
+}
+
+/* Gets the handle of the calling process */
+
+rt_handle_t process_handle(void) {
+	return current_process->handle;
+}
+
+/* Suspends a process: right away, or at the end of its current job for a
+ * periodic process and once it holds no resource for any other
+ */
+
+int process_suspend(rt_handle_t handle) {
+	process_t * process;
+	port_irq_disable();
+	process = find_process(handle);
+	if (process == NULL) {
+		port_irq_enable();
+		return -1;
+	}
+	if (!process->suspended) {
+		process->suspending = 1;
+		if (process == current_process) {
+			if (suspend_due(process)) {
+				process_blocked(); //process_select takes it out of the schedule
+			}
+		}
+		else if (process->is_periodic) {
+			if ((process->release_node.list != NULL) && !process->sleeping) { //Between jobs, waiting for its next release
+				twheel_remove(&not_ready_queue, &process->release_node);
+				park_process(process, RESUME_PERIOD);
+			}
+		}
+		else if (suspend_due(process)) {
+			int where = (process->release_node.list != NULL) ? RESUME_RELEASE : (process->waiting != NULL) ? RESUME_WAIT : RESUME_READY;
+			unqueue_process(process);
+			park_process(process, where);
+		}
+	}
+	port_irq_enable();
+	return 0;
+}
+
+/* Puts a suspended process back where it was, or cancels a suspension that is still pending */
+
+int process_resume(rt_handle_t handle) {
+	process_t * process;
+	heap_node_t * first;
+	port_irq_disable();
+	process = find_process(handle);
+	if (process == NULL) {
+		port_irq_enable();
+		return -1;
+	}
+	process->suspending = 0;
+	if (process->suspended) {
+		update_current_time();
+		resume_process(process);
+		first = heap_peek(&ready_queue);
+		if ((first != NULL) && (!runs_realtime(current_process) || (first->key < current_process->deadline))) { //It is due before the caller
+			process_blocked();
+		}
+	}
+	port_irq_enable();
+	return 0;
+}
+
+/* Frees a process: right away, or once it holds no resource */
+
+int process_kill(rt_handle_t handle) {
+	process_t * process;
+	port_irq_disable();
+	process = find_process(handle);
+	if (process == NULL) {
+		port_irq_enable();
+		return -1;
+	}
+	process->killed = 1;
+	if (process == current_process) {
+		if (process->locks == 0) {
+			process_blocked(); //process_select frees it and never comes back
+		}
+	}
+	else if (process->locks == 0) {
+		if (!process->suspended) {
+			unqueue_process(process);
+		}
+		kill_process(process);
+	}
+	port_irq_enable();
+	return 0;
+}
+
+/* Changes the period of a periodic process from its next release on */
+
+int process_set_period(rt_handle_t handle, realtime_t * period) {
+	return retime_process(handle, 0, tick_from_realtime(period));
+}
+
+/* Changes the relative deadline of a real time process from its next release on */
+
+int process_set_deadline(rt_handle_t handle, realtime_t * deadline) {
+	return retime_process(handle, tick_from_realtime(deadline), 0);
+}
+
+/* Starts up the concurrent execution */
+
+void process_start(void) {
+	current_tick = 0;
+	current_time.sec = 0;
+	current_time.msec = 0;
+	process_stopping = 0;
+	INSTR_RESET();
+	TRACE_RESET();
+	port_timer_start();
+	process_begin();
+}	
+
+/* Gets the id of the calling process */
+
+unsigned int process_id(void) {
+	return current_process->id;
+}
+
+/* Stops the concurrent execution at the next scheduling point */
+
+void process_stop(void) {
+	process_stopping = 1;
+	process_resched = 1;
+}
+
+/* Selects which process to run next */
+
+unsigned int * process_select(unsigned int * cursp) {
+	process_t * preempted = NULL;
+	int resume = 0;
+	INSTR_START(select_start);
+	update_current_time();
+	if (process_stopping) { //process_stop was called, throws away every process and returns to process_start
+		discard_processes();
+		return NULL;
+	}
+	if ((current_process != NULL) && current_process->is_cbs) { //Charges the server for the time the process just ran
+		cbs_charge(current_process);
+	}
+	else if ((current_process != NULL) && current_process->is_realtime) { //Charges the job for the time it just ran
+		current_process->used += current_tick - dispatch_tick;
+	}
+	release_not_ready_queue(); //Moves the processes that have reached their arrival time to the ready queue
+	if (process_events) { //Something was posted to an object a process waits on
+		wake_waiters();
+	}
+#if RT_STACK_PROFILE
+	if ((current_process != NULL) && (current_process->stats != NULL) && !current_process->shared) { //The shared stack is not the use of one task
+		unsigned int used = process_stack_used(current_process->original_sp);
+		if (used > current_process->stats->stack_max) {
+			current_process->stats->stack_max = used;
+		}
+	}
+#endif
+#if RT_STACK_CHECK
+	if ((current_process != NULL) && !process_stack_intact(current_process->original_sp)) { //It ran past the bottom of its stack
+		stack_overflow(current_process);
+		current_process = NULL;
+		cursp = NULL;
+	}
+#endif
+	if (cursp == NULL) { 
+		if (current_process != NULL) { //If there is a current process and it is done running
+			if (current_process->locks > 0) { //It finished without unlocking
+				release_resources(current_process);
+			}
+			finish_job(current_process);
+			if (current_process->is_periodic && !current_process->killed) { //If the current process is periodic
+				next_job(current_process);
+			}
+			else {
+				free_process(current_process); //Frees the process as it is done running (for non-periodic processes only)
+			}
+		}
+	}
+	else { //The current process is not done running
+		current_process->sp = cursp;
+		if (budget_exhausted(current_process, current_process->used) && !budget_overrun(current_process)) { //The job was dropped
+			current_process = NULL;
+		}
+		else if (abort_due(current_process)) { //It passed its deadline in a critical section and has left it
+			abort_job(current_process);
+			current_process = NULL;
+		}
+		else if (current_process->killed && (current_process->locks == 0)) { //process_kill
+			kill_process(current_process);
+			current_process = NULL;
+		}
+		else if (suspend_due(current_process)) { //process_suspend
+			TRACE(TRACE_SLEEP, current_process->id, 0);
+			park_process(current_process, RESUME_READY);
+			current_process = NULL;
+		}
+		else if (current_process->sleeping) { //It waits for its wakeup time, not for the processor
+			TRACE(TRACE_SLEEP, current_process->id, current_process->wake_time - current_tick);
+			add_not_ready_queue(current_process);
+		}
+		else if (current_process->waiting != NULL) { //It waits for an event
+			if (current_process->is_realtime) { //The job is done, the event releases the next one
+				finish_job(current_process);
+			}
+			else {
+				TRACE(TRACE_SLEEP, current_process->id, 0);
+			}
+			current_process->next = waiting_processes;
+			waiting_processes = current_process;
+			if (current_process->waiting->signalled) { //Posted to on the way here
+				wake_waiters();
+			}
+		}
+		else {
+			preempted = current_process;
+			resume = keeps_running(current_process); //If nothing has to run ahead of it, it skips the round trip through the queues
+			if (!resume) {
+				if (runs_realtime(current_process)) {
+					add_ready_queue(current_process); //Adds to real time ready queue
+				}
+				else if (current_process->locks > 0) { //Goes on with its critical section as soon as the real time processes are done
+					current_process->next = process_queue;
+					process_queue = current_process;
+				}
+				else {
+					add_process_queue(current_process); //Adds to normal non-real time queue
+				}
+			}
+		}
+	}
+	if ((current_tick >= next_deadline) && expire_deadlines(preempted, resume)) { //The preempted job was dropped at its deadline
+		preempted = NULL;
+		resume = 0;
+	}
+	if (system_ceiling != SRP_NO_CEILING) { //Holds back the ready processes that may not start yet
+		block_ready_queue();
+	}
+	if (!resume) {
+		drop_unfit_jobs();
+	}
+	if (resume) { //The preempted process carries on
+	}
+	else if (ready_queue.root != NULL) { //If there are processes in the ready queue (real time processes)
+		current_process = remove_ready_queue();
+	}	
+	else if (process_queue != NULL) { //Else if there are processes in the process queue (non-real time processes)
+		current_process = remove_process_queue();
+	}	
+	else if ((not_ready_queue.count != 0) || (waiting_processes != NULL) || (suspended_processes != 0)) {//Else if there are processes in the not ready queue, waiting for an event or suspended
+		current_process = NULL; //Nothing runs while the scheduler sleeps
+		TRACE(TRACE_IDLE, 0, 0);
+		INSTR_PAUSE(select_start); //Time asleep isn't scheduler overhead
+		while ((ready_queue.root == NULL) && (process_queue == NULL) && !process_stopping) { //Sleeps until a process becomes ready
+			tick_t wake = (not_ready_queue.count != 0) ? twheel_next(&not_ready_queue) : TWHEEL_NEVER;
+			if (next_deadline < wake) { //A sleeping job has a deadline to enforce first
+				wake = next_deadline;
+			}
+			if (wake != TWHEEL_NEVER) {
+				port_timer_wakeup(wake); //Asks for a wakeup at the next release (tickless mode)
+			}
+			port_idle(); //Enables interrupt while asleep or the process will never become ready
+			update_current_time();
+			release_not_ready_queue();
+			if (current_tick >= next_deadline) {
+				expire_deadlines(NULL, 0);
+			}
+			if (process_events) {
+				wake_waiters();
+			}
+		}
+		INSTR_RESUME(select_start);
+		if (process_stopping) {
+			discard_processes();
+			return NULL;
+		}
+		if (ready_queue.root != NULL) {
+			current_process = remove_ready_queue();
+		}
+		else { //A non real time process woke up
+			current_process = remove_process_queue();
+		}
+	}
+	else {//There are no processes left
+		current_process = NULL;
+		next_process_id = 1;
+		twheel_init(&not_ready_queue, 0); //The time starts over at 0 if process_start is called again
+		twheel_init(&deadline_queue, 0);
+		next_deadline = TWHEEL_NEVER;
+	}
+	if ((preempted != NULL) && (preempted != current_process)) { //Another process takes over before the job is done
+		TRACE(TRACE_PREEMPT, preempted->id, 0);
+		if (preempted->stats != NULL) {
+			preempted->stats->preemptions += 1;
+		}
+	}
+	if ((current_process != NULL) && (current_process != preempted)) {
+		TRACE(TRACE_DISPATCH, current_process->id, 0);
+	}
+	if ((current_process != NULL) && current_process->is_realtime && !current_process->job_started) { //The first time this job runs
+		if (current_process->shared) { //A basic job starts on the shared stack, below the jobs it preempts
+			shared_frame_start(current_process);
+		}
+		record_job_start(current_process);
+	}
+	dispatch_tick = current_tick;
+	//Until something is released, only time slicing between non real time processes needs the next PIT0 tick
+	process_resched = (current_process != NULL) && !runs_realtime(current_process) && (process_queue != NULL);
+	if (current_process != NULL) {
+		arm_wakeup();
+	}
+	INSTR_STOP(INSTR_SELECT, select_start);
+	if (current_process == NULL) { //If there is no current process running
+		return NULL;
+  }
+	else {
+		return current_process->sp;
+	}
+}
+
+/* Called by the timer interrupt whenever time has advanced */
+
+void process_timer_interrupt(void) {
+	heap_node_t * first;
+	update_current_time();
+	if (current_tick >= next_release) { //Releases the processes that have arrived right away
+		release_not_ready_queue();
+	}
+	if (current_process == NULL) { //process_select is waiting for a release and picks it up itself
+		return;
+	}
+	first = heap_peek(&ready_queue);
+	if (((first != NULL) && (!runs_realtime(current_process) || (first->key < current_process->deadline))) //A release is ahead of the running process
+			|| (current_process->is_cbs && (current_tick - dispatch_tick >= current_process->remaining)) //The server budget ran out
+			|| budget_exhausted(current_process, current_process->used + current_tick - dispatch_tick) //The job ran out of budget
+			|| (current_tick >= next_deadline)) { //A firm or soft job reached its deadline unfinished
+		process_resched = 1;
+#if RT_EVENT_PREEMPT
+		port_pend_resched(); //Switches as soon as this interrupt returns instead of at the next PIT0 tick
+#endif
+	}
+	arm_wakeup();
+}
+			
+/* Helper functions */
+
+/* Adds process to the end of the process queue */
+
+void add_process_queue(process_t * next_process) {
+	if (process_queue == NULL) {
+		process_queue = next_process;
+		next_process->next = NULL;
+	}
+	else {
+		process_t * tmp = process_queue;
+		while (tmp->next != NULL) {
+			tmp = tmp->next;
+		}
+		tmp->next = next_process;
+		next_process->next = NULL;
+	}	
+	process_resched = 1; //Time slicing is needed if it shares the processor with a running non real time process
+}	
+
+/* Removes the first process in the process queue and return the first process of the queue after the removal */
+
+process_t * remove_process_queue(void) {
+	if (process_queue == NULL) {
+		return NULL;
+	}
+	else {
+		process_t * temp = process_queue;
+		process_queue = process_queue->next;
+		temp->next = NULL;
+		return temp;
+  }
+}	
+
+/* Adds process to the not ready queue (released once the current time
+ * reaches its arrival time, or its wakeup time if it is sleeping)
+ */
+
+void add_not_ready_queue(process_t * next_process) {
+	INSTR_START(insert_start);
+	tick_t when = next_process->sleeping ? next_process->wake_time : next_process->arrival_time;
+	next_process->next = NULL;
+	next_process->release_node.expires = when;
+	twheel_insert(&not_ready_queue, &next_process->release_node);
+	if (when < next_release) {
+		next_release = when;
+	}
+	process_resched = 1; //Makes process_select arm the tickless wakeup for it if the process is created while others run
+	INSTR_STOP(INSTR_INSERT, insert_start);
+}	
+
+/* Updates current_tick (and the current_time copy of it) from the timer */
+
+void update_current_time(void) {
+	tick_t now = port_time_now();
+	if (now == current_tick + 1) { //The common case of a single tick, avoids a 64-bit division
+		current_time.msec += 1;
+		if (current_time.msec >= 1000) {
+			current_time.sec += 1;
+			current_time.msec = 0;
+		}
+	}
+	else if (now != current_tick) {
+		tick_to_realtime(now, &current_time);
+	}
+	current_tick = now;
+}
+
+/* Throws away every process at once by emptying the queues and the pools (used by process_stop) */
+
+void discard_processes(void) {
+	int i;
+	current_process = NULL;
+	process_queue = NULL;
+	heap_init(&ready_queue);
+	twheel_init(&not_ready_queue, 0);
+	next_release = TWHEEL_NEVER;
+	twheel_init(&deadline_queue, 0);
+	next_deadline = TWHEEL_NEVER;
+	while (locked_resources != NULL) { //The resources are free again for the next process_start
+		locked_resources->owner = NULL;
+		locked_resources = locked_resources->below;
+	}
+	system_ceiling = SRP_NO_CEILING;
+	blocked_processes = NULL;
+	while (waiting_processes != NULL) { //The objects no longer have a waiter
+		waiting_processes->waiting->waiter = NULL;
+		waiting_processes = waiting_processes->next;
+	}
+	process_events = 0;
+	next_process_id = 1;
+	suspended_processes = 0;
+	shared_stack = NULL; //Its block goes back with the stack pools below
+	shared_frames = NULL;
+	shared_tasks = 0;
+	shared_level_count = 0;
+	shared_depth = 0;
+	for (i = 0; i < RT_MAX_PROCESSES; i++) { //The handles of the discarded processes stop working
+		if (handle_table[i].process != NULL) {
+			handle_table[i].process = NULL;
+			handle_table[i].generation += 1;
+		}
+	}
+	pool_reset(&process_pool);
+	admit_init(&admitted_tasks);
+	admit_snapshot_busy = 0;
+	for (i = 0; i < RT_MAX_TASK_STATS; i++) {
+		task_stats[i].processes = 0;
+	}
+	for (i = 0; i < RT_STACK_CLASSES; i++) {
+		pool_reset(&process_stack_pools[i]);
+	}
+}
+
+/* Returns the statistics entry of a new process running f, claiming a free one for a new function (NULL if the table is full) */
+
+task_stats_t * find_task_stats(void (* f)(void)) {
+	int i;
+	task_stats_t * t = NULL;
+	port_irq_disable(); //free_process gives entries back from the scheduler
+	for (i = 0; (i < RT_MAX_TASK_STATS) && (t == NULL); i++) {
+		if (task_stats[i].f == f) {
+			t = &task_stats[i];
+		}
+	}
+	for (i = 0; (i < RT_MAX_TASK_STATS) && (t == NULL); i++) {
+		if (task_stats[i].f == NULL) {
+			t = &task_stats[i];
+			t->f = f;
+			t->delay_min = ~(tick_t) 0;
+		}
+	}
+	if (t != NULL) {
+		t->processes += 1;
+	}
+	port_irq_enable();
+	return t;
+}
+
+/* Records the start delay of a job that is about to run for the first time */
+
+void record_job_start(process_t * process) {
+	task_stats_t * t = process->stats;
+	process->job_started = 1;
+	if (t != NULL) {
+		tick_t delay = (current_tick > process->arrival_time) ? current_tick - process->arrival_time : 0;
+		if (delay < t->delay_min) {
+			t->delay_min = delay;
+		}
+		if (delay > t->delay_max) {
+			t->delay_max = delay;
+		}
+	}
+}
+
+/* Records the response time and lateness of a job that just finished */
+
+void record_job_end(process_t * process) {
+	task_stats_t * t = process->stats;
+	if (t != NULL) {
+		tick_t response = current_tick - process->arrival_time;
+		long long lateness = (long long) (current_tick - process->deadline);
+		if ((t->jobs == 0) || (lateness > t->lateness_max)) {
+			t->lateness_max = lateness;
+		}
+		if (current_tick > process->deadline) {
+			t->misses += 1;
+		}
+		if (response > t->response_max) {
+			t->response_max = response;
+		}
+		t->response_total += response;
+		t->jobs += 1;
+	}
+}
+
+/* Moves a periodic process on to its next job: the arrival time advances
+ * by whole periods from the first one and the deadline is always the
+ * arrival time plus the relative deadline. A job that finished after the
+ * next arrival time is handled by the overrun policy of the process.
+ */
+
+void rearm_periodic(process_t * process) {
+	process->arrival_time += process->period;
+	if ((process->arrival_time < current_tick) && (process->period != 0)) { //The job overran into the next period
+		if (process->overrun == RT_OVERRUN_SKIP) { //Moves on to the first arrival time that hasn't passed
+			tick_t missed = (current_tick - process->arrival_time + process->period - 1) / process->period;
+			process->arrival_time += missed * process->period;
+			if (process->stats != NULL) {
+				process->stats->skipped += missed;
+			}
+		}
+		else if (process->overrun == RT_OVERRUN_IMMEDIATE) { //Arrives now, the following periods count from here
+			process->arrival_time = current_tick;
+		}
+	}
+	process->deadline = process->arrival_time + process->relative_deadline;
+}
+
+/* Gives a server process that has just arrived its deadline and budget.
+ * The current deadline and budget are kept only if the remaining budget
+ * can still be used up before the deadline without exceeding the server
+ * bandwidth; otherwise the budget is refilled with a deadline one period
+ * from now.
+ */
+
+void cbs_arrive(process_t * process) {
+	if ((process->deadline <= current_tick)
+			|| (process->remaining * process->period >= (process->deadline - current_tick) * process->budget)) {
+		process->deadline = current_tick + process->period;
+		process->remaining = process->budget;
+	}
+}
+
+/* Charges a server process for the time since it was switched in. Each
+ * time the budget runs out it is refilled and the deadline is postponed by
+ * one period, which drops the process behind the tasks it was delaying.
+ */
+
+void cbs_charge(process_t * process) {
+	tick_t used = current_tick - dispatch_tick;
+	while (used >= process->remaining) {
+		used -= process->remaining;
+		process->remaining = process->budget;
+		process->deadline += process->period;
+	}
+	process->remaining -= used;
+}
+
+/* Runs admission control for a new process that declared its worst-case
+ * execution time (processes that didn't are let through unchecked).
+ * Returns 0 if the process is admitted, -1 if it would make the admitted
+ * task set unschedulable.
+ */
+
+int admit_process(process_t * process, tick_t wcet, tick_t deadline, tick_t period) {
+	int fits;
+	process->admitted = 0;
+	if (wcet == 0) {
+		return 0;
+	}
+	process->admit_node.wcet = wcet;
+	process->admit_node.deadline = deadline;
+	process->admit_node.period = period;
+	fits = admit_test(&process->admit_node, 0);
+	if (fits) {
+		admit_insert(&admitted_tasks, &process->admit_node);
+		process->admitted = 1;
+	}
+	port_irq_enable();
+	return fits ? 0 : -1;
+}
+
+/* Tells whether the admitted tasks, with task (its wcet, deadline and
+ * period set) in place of the admitted task of process replaces (0 for
+ * none), stay schedulable. Call with interrupts enabled. The O(1) checks
+ * run with interrupts disabled, but the demand test can take a long time
+ * on a large set, so it runs with interrupts enabled on a copy of the set
+ * (admit_snapshot_copy) and is run again if a task was admitted
+ * meanwhile. Returns with interrupts disabled, 1 if the set stays
+ * schedulable and 0 if not, which holds until they are enabled again.
+ */
+
+int admit_test(admit_task_t * task, rt_handle_t replaces) {
+	unsigned int additions;
+	admit_task_t * old;
+	int fits;
+	while (1) {
+		port_irq_disable();
+		old = admitted_node(replaces);
+		fits = admit_quick(&admitted_tasks, task, old);
+		if (fits != ADMIT_TEST) {
+			return fits == ADMIT_YES;
+		}
+		if (admit_snapshot_busy) { //This preempted another admission test that uses the snapshot, tests the set itself
+			if (old != NULL) {
+				admit_remove(&admitted_tasks, old);
+			}
+			fits = admit_demand_test(&admitted_tasks, task);
+			if (old != NULL) {
+				admit_insert(&admitted_tasks, old);
+			}
+			return fits;
+		}
+		admit_snapshot_busy = 1;
+		additions = admitted_tasks.additions;
+		port_irq_enable();
+		fits = (admit_snapshot_copy(old) == 0) ? admit_demand_test(&admit_snapshot, task) : -1;
+		port_irq_disable();
+		admit_snapshot_busy = 0;
+		if ((fits >= 0) && (admitted_tasks.additions == additions)) { //Tasks that left meanwhile only lower the demand
+			return fits;
+		}
+		port_irq_enable();
+	}
+}
+
+/* Returns the node of the admitted task of process handle, NULL if there is none */
+
+admit_task_t * admitted_node(rt_handle_t handle) {
+	process_t * process = find_process(handle);
+	return ((process != NULL) && process->admitted) ? &process->admit_node : NULL;
+}
+
+/* Copies the admitted tasks but skip into admit_snapshot, with interrupts
+ * disabled for ADMIT_SNAPSHOT_CHUNK of them at a time. Call with
+ * interrupts enabled. Returns 0, or -1 if the set changed while it was
+ * copied.
+ */
+
+int admit_snapshot_copy(admit_task_t * skip) {
+	admit_task_t * node;
+	unsigned int changes, count = 0, seen = 0;
+	admit_init(&admit_snapshot);
+	port_irq_disable();
+	changes = admitted_tasks.changes;
+	for (node = admitted_tasks.tasks; node != NULL; node = node->next) {
+		if (node != skip) {
+			admit_snapshot_tasks[count] = *node;
+			admit_insert(&admit_snapshot, &admit_snapshot_tasks[count]);
+			count++;
+		}
+		if (++seen % ADMIT_SNAPSHOT_CHUNK == 0) { //Lets pending interrupts in, then carries on if none of them changed the set
+			port_irq_enable();
+			port_irq_disable();
+			if (admitted_tasks.changes != changes) {
+				port_irq_enable();
+				return -1;
+			}
+		}
+	}
+	port_irq_enable();
+	return 0;
+}
+
+/* Takes a process out of the admitted task set if it is in it */
+
+void dismiss_process(process_t * process) {
+	if (process->admitted) {
+		admit_remove(&admitted_tasks, &process->admit_node);
+		process->admitted = 0;
+	}
+}
+
+/* Takes the struct of a new process from its pool, NULL if it is used up.
+ * process_select frees processes to the same pools from the scheduler
+ * interrupt, so the pools are only touched with interrupts disabled.
+ */
+
+process_t * alloc_process(void) {
+	process_t * process;
+	port_irq_disable();
+	process = pool_alloc(&process_pool);
+	port_irq_enable();
+	if (process != NULL) {
+		process->admitted = 0; //Not in the admitted task set until admit_process
+	}
+	return process;
+}
+
+/* Takes a stack of n words for a new process running f (process_stack_init), NULL if there is none */
+
+unsigned int * alloc_stack(void (* f)(void), int n) {
+	unsigned int * sp;
+	port_irq_disable();
+	sp = process_stack_init(f, n);
+	port_irq_enable();
+	return sp;
+}
+
+/* Gives back the struct of a process that could not be created, and its place in the admitted task set */
+
+void unalloc_process(process_t * process) {
+	port_irq_disable();
+	dismiss_process(process);
+	pool_free(&process_pool, process);
+	port_irq_enable();
+}
+
+/* Stops a process that has overwritten the guard word of its stack. The
+ * memory below the stack may already be corrupt, so the process is thrown
+ * away rather than resumed, whatever kind it is.
+ */
+
+void stack_overflow(process_t * process) {
+	process_stack_overflows += 1;
+	if (process->locks > 0) {
+		release_resources(process);
+	}
+	free_process(process);
+}
+
+/* Frees a process that is done and the memory it holds */
+
+void free_process(process_t * process) {
+	dismiss_process(process); //Its demand no longer counts against new processes
+	disarm_deadline(process);
+	handle_free(process);
+	if (process->stats != NULL) {
+		process->stats->processes -= 1;
+	}
+	if (process->shared) {
+		shared_frame_end(process);
+		shared_level_leave(process->relative_deadline);
+		if (process->new_deadline != 0) {
+			shared_level_leave(process->new_deadline);
+		}
+		shared_tasks -= 1;
+		if (shared_tasks == 0) { //The last basic task gives the shared stack back
+			process_stack_free(shared_stack, RT_SHARED_STACK_WORDS);
+			shared_stack = NULL;
+		}
+	}
+	else {
+		process_stack_free(process->original_sp, process->stack_size);
+	}
+	pool_free(&process_pool, process);
+}
+
+/* Returns whether a ready process may run under the system ceiling: it
+ * has already started, or its relative deadline is shorter than the
+ * ceiling of every locked resource
+ */
+
+int srp_eligible(process_t * process) {
+	return process->job_started || (process->relative_deadline < system_ceiling);
+}
+
+/* Moves the ready processes that the system ceiling keeps from starting
+ * out of the front of the ready queue, so the one it leaves in front is
+ * the earliest deadline that may run
+ */
+
+void block_ready_queue(void) {
+	heap_node_t * first = heap_peek(&ready_queue);
+	while ((first != NULL) && !srp_eligible(READY_PROCESS(first))) {
+		process_t * blocked = remove_ready_queue();
+		blocked->next = blocked_processes;
+		blocked_processes = blocked;
+		first = heap_peek(&ready_queue);
+	}
+}
+
+/* Puts the processes held back by the system ceiling back in the ready queue */
+
+void unblock_processes(void) {
+	while (blocked_processes != NULL) {
+		process_t * blocked = blocked_processes;
+		blocked_processes = blocked->next;
+		add_ready_queue(blocked);
+	}
+}
+
+/* Unlocks the last locked resource and lowers the system ceiling to what it was before */
+
+void unlock_resource(rt_resource_t * resource) {
+	locked_resources = resource->below;
+	system_ceiling = resource->ceiling_below;
+	resource->owner->locks -= 1;
+	resource->owner = NULL;
+	resource->below = NULL;
+	unblock_processes(); //process_select holds back the ones that still may not start
+	process_resched = 1;
+}
+
+/* Counts a job that just finished (or started to wait for an event) against its deadline */
+
+void finish_job(process_t * process) {
+	TRACE(TRACE_COMPLETE, process->id, 0);
+	if (process->is_realtime) {
+		disarm_deadline(process);
+		if ((current_tick > process->deadline) && !process->is_cbs) {
+			TRACE(TRACE_MISS, process->id, current_tick - process->deadline);
+		}
+		if (!process->is_cbs) { //Server deadlines are not hard deadlines
+			if (current_tick <= process->deadline) { //Checks whether the process misses its deadline
+				process_deadline_met += 1; //Updates number of processes that met the deadline
+			}
+			else {
+				process_deadline_miss += 1; //Updates number of processes that missed the deadline
+			}
+		}
+		record_job_end(process);
+	}
+}
+
+/* Makes every waiting process whose object has been posted to ready. A
+ * real time process gets a new job that arrived at the time of the post.
+ */
+
+void wake_waiters(void) {
+	process_t ** link = &waiting_processes;
+	process_events = 0;
+	while (*link != NULL) {
+		process_t * process = *link;
+		rt_wait_t * wait = process->waiting;
+		if (!wait->signalled) {
+			link = &process->next;
+			continue;
+		}
+		*link = process->next;
+		wait->waiter = NULL;
+		process->waiting = NULL;
+		if (process->is_realtime) {
+			process->arrival_time = current_tick - (unsigned int) ((unsigned int) current_tick - wait->posted);
+			process->job_started = 0;
+			process->used = 0;
+			process->budget_spent = 0;
+			process->demoted = 0;
+			if (process->is_cbs) {
+				cbs_arrive(process);
+			}
+			else {
+				process->deadline = process->arrival_time + process->relative_deadline;
+				release_job(process);
+			}
+			TRACE(TRACE_RELEASE, process->id, release_delay(process));
+			add_ready_queue(process);
+		}
+		else {
+			TRACE(TRACE_WAKE, process->id, 0);
+			add_process_queue(process);
+		}
+	}
+}
+
+/* Moves a periodic process on to its next job and queues it */
+
+void next_job(process_t * process) {
+	if (process->shared) { //A basic job gets a new frame when it is dispatched
+		shared_frame_end(process);
+	}
+	else {
+		process_stack_reinit(process);
+	}
+	process->job_started = 0;
+	process->used = 0;
+	process->budget_spent = 0;
+	process->demoted = 0;
+	rearm_periodic(process); //Updates arrival time and deadline for the next job
+	if (process->suspending) { //process_suspend, this is the job boundary it waited for
+		park_process(process, RESUME_PERIOD);
+	}
+	else if (current_tick >= process->arrival_time) { //Check whether the process becomes ready or not
+		TRACE(TRACE_RELEASE, process->id, release_delay(process));
+		release_job(process);
+		add_ready_queue(process);
+	}
+	else {
+		add_not_ready_queue(process);
+	}
+}
+
+/* Returns whether a process is scheduled as a real time process (a
+ * demoted job is not, until it finishes)
+ */
+
+int runs_realtime(process_t * process) {
+	return process->is_realtime && !process->demoted;
+}
+
+/* Returns whether a job that has had used ticks of processor time is due
+ * for its budget action: its budget is enforced, overrun (a job may use
+ * all of it, time is only counted in whole ticks) and the action not
+ * taken yet, and it holds no resource
+ */
+
+int budget_exhausted(process_t * process, tick_t used) {
+	return (process->budget_action != RT_BUDGET_NONE) && (process->wcet != 0) && !process->budget_spent
+		&& (process->locks == 0) && (used > process->wcet);
+}
+
+/* Calls the budget hook of a job that ran out of budget and takes its
+ * budget action. Returns 1 if the job goes on, 0 if it was dropped (the
+ * process is then queued for its next job or freed).
+ */
+
+int budget_overrun(process_t * process) {
+	process->budget_spent = 1;
+	TRACE(TRACE_OVERRUN, process->id, process->budget_action);
+	if (process->stats != NULL) {
+		process->stats->overruns += 1;
+	}
+	if (process->budget_hook != NULL) {
+		process->budget_hook();
+	}
+	if (process->budget_action == RT_BUDGET_DEMOTE) {
+		process->demoted = 1;
+		return 1;
+	}
+	if (process->budget_action != RT_BUDGET_SUSPEND) {
+		return 1;
+	}
+	drop_job(process);
+	return 0;
+}
+
+/* Drops the current job of a process before it finishes and counts it as
+ * a miss. A periodic process is queued for its next job, which starts
+ * over from the beginning of its function; any other process is freed.
+ */
+
+void drop_job(process_t * process) {
+	TRACE(TRACE_COMPLETE, process->id, 0);
+	disarm_deadline(process);
+	process->sleeping = 0;
+	process_deadline_miss += 1; //A dropped job never meets its deadline
+	if (process->stats != NULL) {
+		process->stats->jobs += 1;
+		process->stats->misses += 1;
+	}
+	if (process->is_periodic) {
+		next_job(process);
+	}
+	else {
+		free_process(process);
+	}
+}
+
+/* Starts the deadline timer of a job that was just released, if its
+ * process does something when a job reaches its deadline unfinished
+ */
+
+void arm_deadline(process_t * process) {
+	process->expired = 0;
+	if ((process->deadline_policy != RT_DEADLINE_HARD) && !process->is_cbs) {
+		process->deadline_node.expires = process->deadline + 1; //A job that is still pending then has missed
+		twheel_insert(&deadline_queue, &process->deadline_node);
+		if (process->deadline_node.expires < next_deadline) {
+			next_deadline = process->deadline_node.expires;
+		}
+	}
+}
+
+/* Stops the deadline timer of a job that is done (if it runs) */
+
+void disarm_deadline(process_t * process) {
+	twheel_remove(&deadline_queue, &process->deadline_node);
+}
+
+/* Handles the jobs whose deadline has passed: the deadline hook of each
+ * is called, and a firm job is dropped right away wherever it waits, or
+ * once it has unlocked its resources if it holds any. preempted is the
+ * process that was running, still running if resume is set and queued
+ * otherwise. Returns whether preempted was dropped.
+ */
+
+int expire_deadlines(process_t * preempted, int resume) {
+	int dropped = 0;
+	twheel_node_t * node = twheel_advance(&deadline_queue, current_tick);
+	next_deadline = twheel_next(&deadline_queue);
+	while (node != NULL) {
+		twheel_node_t * next = node->next;
+		process_t * process = DEADLINE_PROCESS(node);
+		process->expired = 1;
+		TRACE(TRACE_EXPIRE, process->id, process->deadline_policy);
+		if (process->deadline_hook != NULL) {
+			process_t * running = current_process;
+			current_process = process; //So that process_id() in the hook is the late process
+			process->deadline_hook();
+			current_process = running;
+		}
+		if (abort_due(process)) {
+			if (process == preempted) {
+				dropped = 1;
+			}
+			if ((process != preempted) || !resume) {
+				unqueue_process(process);
+			}
+			abort_job(process);
+		}
+		node = next;
+	}
+	return dropped;
+}
+
+/* Returns whether a job is due to be dropped at its deadline: its process
+ * is firm, the deadline has passed, it holds no resource and it is not
+ * suspended (then it is dropped when it is resumed)
+ */
+
+int abort_due(process_t * process) {
+	return process->expired && (process->deadline_policy == RT_DEADLINE_FIRM) && (process->locks == 0) && !process->suspended;
+}
+
+/* Drops a firm job that has passed its deadline (it is in no queue) */
+
+void abort_job(process_t * process) {
+	if (process->stats != NULL) {
+		process->stats->aborts += 1;
+	}
+	drop_job(process);
+}
+
+/* Starts a job that was just released: applies the period and deadline
+ * changes asked for since the last release and starts the deadline timer
+ */
+
+void release_job(process_t * process) {
+	if (process->new_period != 0) { //The next release is one new period after this one
+		process->period = process->new_period;
+		process->new_period = 0;
+	}
+	if (process->new_deadline != 0) {
+		if (process->shared) { //It joined the level of its new deadline when that was set
+			shared_level_leave(process->relative_deadline);
+		}
+		process->relative_deadline = process->new_deadline;
+		process->deadline = process->arrival_time + process->relative_deadline;
+		process->new_deadline = 0;
+	}
+	arm_deadline(process);
+}
+
+/* Returns how long after its arrival time a job is put in the ready
+ * queue, for TRACE_RELEASE (0 for a non real time process)
+ */
+
+tick_t release_delay(process_t * process) {
+	if (!process->is_realtime || (current_tick <= process->arrival_time)) {
+		return 0;
+	}
+	return current_tick - process->arrival_time;
+}
+
+/* Gives a new process the handle of its struct in the handle table */
+
+rt_handle_t handle_create(process_t * process) {
+	unsigned int index = process - process_memory;
+	handle_table[index].process = process;
+	return ((handle_table[index].generation & HANDLE_INDEX_MASK) << HANDLE_INDEX_BITS) | (index + 1);
+}
+
+/* Ends the handle of a process that is being freed */
+
+void handle_free(process_t * process) {
+	unsigned int index = process - process_memory;
+	handle_table[index].process = NULL;
+	handle_table[index].generation += 1;
+}
+
+/* Returns the process a handle names, NULL if it names none (any more) */
+
+process_t * find_process(rt_handle_t handle) {
+	unsigned int index = (handle & HANDLE_INDEX_MASK) - 1; //Handle 0 wraps around to an index that is out of range
+	if ((index >= RT_MAX_PROCESSES) || (handle_table[index].process == NULL)
+			|| ((handle_table[index].generation & HANDLE_INDEX_MASK) != (handle >> HANDLE_INDEX_BITS))) {
+		return NULL;
+	}
+	return handle_table[index].process;
+}
+
+/* Changes the relative deadline (deadline != 0) or the period (period !=
+ * 0) of process handle from its next release on, after running admission
+ * control again if the process was admitted. Returns 0 if it changed, -1
+ * if the process may not have it changed, -2 if the new value would make
+ * the admitted task set unschedulable (the old one stays).
+ */
+
+int retime_process(rt_handle_t handle, tick_t deadline, tick_t period) {
+	admit_task_t task;
+	process_t * process;
+	int fits = 1;
+	port_irq_disable();
+	process = find_process(handle);
+	if (!retime_valid(process, deadline, period)) {
+		port_irq_enable();
+		return -1;
+	}
+	while (process->admitted) {
+		task = process->admit_node;
+		task.deadline = (deadline != 0) ? deadline : task.deadline;
+		task.period = (period != 0) ? period : task.period;
+		port_irq_enable();
+		fits = admit_test(&task, handle);
+		process = find_process(handle);
+		if (!retime_valid(process, deadline, period)) { //It went away meanwhile
+			port_irq_enable();
+			return -1;
+		}
+		if ((deadline != 0) ? (process->admit_node.period == task.period) : (process->admit_node.deadline == task.deadline)) { //The value that stays is the one tested
+			if (fits) {
+				admit_remove(&admitted_tasks, &process->admit_node);
+				process->admit_node = task;
+				admit_insert(&admitted_tasks, &process->admit_node);
+			}
+			break;
+		}
+		//A change of the other value came in meanwhile, tests again with it
+	}
+	if (fits) {
+		if (deadline != 0) {
+			if (process->shared) { //Counts at both deadlines until the new one takes over
+				if (process->new_deadline != 0) {
+					shared_level_leave(process->new_deadline);
+				}
+				shared_level_join(process->stack_size, deadline);
+			}
+			process->new_deadline = deadline;
+		}
+		else {
+			process->new_period = period;
+		}
+	}
+	port_irq_enable();
+	return fits ? 0 : -2;
+}
+
+/* Returns whether process exists and may have its relative deadline (deadline != 0) or period changed to that */
+
+int retime_valid(process_t * process, tick_t deadline, tick_t period) {
+	if ((process == NULL) || process->is_cbs) {
+		return 0;
+	}
+	if (period != 0) {
+		return process->is_periodic;
+	}
+	return process->is_realtime && (deadline != 0)
+		&& (!process->shared || (shared_stack_depth(process->stack_size, deadline) <= RT_SHARED_STACK_WORDS + PROCESS_CONTEXT_WORDS)); //A basic task may not deepen the preemption chain past the shared stack
+}
+
+/* Returns whether a process is due to be suspended now: it was asked to
+ * be, holds no resource, is not periodic (those are suspended between
+ * jobs by next_job) and is not a basic job that has started (its frame
+ * has to leave the shared stack first, so it runs to the end)
+ */
+
+int suspend_due(process_t * process) {
+	return process->suspending && (process->locks == 0) && !process->is_periodic && !(process->shared && process->job_started);
+}
+
+/* Returns whether the running process has to give up the processor for
+ * good as soon as it holds no resource: it is firm and late, suspended or
+ * killed
+ */
+
+int stop_due(process_t * process) {
+	return abort_due(process) || suspend_due(process) || (process->killed && (process->locks == 0));
+}
+
+/* Takes a process that is in no queue out of the schedule until
+ * process_resume puts it back in where
+ */
+
+void park_process(process_t * process, int where) {
+	process->suspending = 0;
+	process->suspended = where;
+	suspended_processes += 1;
+}
+
+/* Puts a suspended process back in the schedule. A periodic process waits
+ * for the first release that has not passed yet, and a firm job whose
+ * deadline passed in the meantime is dropped.
+ */
+
+void resume_process(process_t * process) {
+	int where = process->suspended;
+	process->suspended = 0;
+	suspended_processes -= 1;
+	if (abort_due(process)) {
+		abort_job(process);
+	}
+	else if (where == RESUME_PERIOD) {
+		if ((process->arrival_time < current_tick) && (process->period != 0)) { //The releases while it was suspended are not made up for
+			process->arrival_time += (current_tick - process->arrival_time + process->period - 1) / process->period * process->period;
+		}
+		process->deadline = process->arrival_time + process->relative_deadline;
+		add_not_ready_queue(process);
+	}
+	else if (where == RESUME_RELEASE) {
+		add_not_ready_queue(process);
+	}
+	else if (where == RESUME_WAIT) {
+		process->next = waiting_processes;
+		waiting_processes = process;
+		if (process->waiting->signalled) { //Posted to while it was suspended
+			process_events = 1;
+		}
+	}
+	else {
+		TRACE(TRACE_WAKE, process->id, 0);
+		if (runs_realtime(process)) {
+			add_ready_queue(process);
+		}
+		else {
+			add_process_queue(process);
+		}
+	}
+	process_resched = 1;
+}
+
+/* Frees a killed process that is in no queue */
+
+void kill_process(process_t * process) {
+	TRACE(TRACE_COMPLETE, process->id, 0);
+	if (process->waiting != NULL) { //The object no longer has a waiter
+		process->waiting->waiter = NULL;
+	}
+	if (process->suspended) {
+		suspended_processes -= 1;
+	}
+	free_process(process);
+}
+
+/* Takes a process that is not running out of the queue it waits in */
+
+void unqueue_process(process_t * process) {
+	if (process->release_node.list != NULL) { //Asleep, or waiting for its arrival time
+		twheel_remove(&not_ready_queue, &process->release_node);
+	}
+	else if (process->waiting != NULL) {
+		unlink_process(&waiting_processes, process);
+	}
+	else if (!unlink_process(&process_queue, process) && !unlink_process(&blocked_processes, process)) { //A demoted job, or one the system ceiling holds back
+		remove_ready_process(process);
+	}
+}
+
+/* Takes a process out of a list linked through next. Returns whether it was in the list */
+
+int unlink_process(process_t ** list, process_t * process) {
+	while (*list != NULL) {
+		if (*list == process) {
+			*list = process->next;
+			process->next = NULL;
+			return 1;
+		}
+		list = &(*list)->next;
+	}
+	return 0;
+}
+
+/* Takes a process out of the ready queue */
+
+void remove_ready_process(process_t * process) {
+	INSTR_START(remove_start);
+	heap_remove(&ready_queue, &process->ready_node);
+	INSTR_STOP(INSTR_REMOVE, remove_start);
+}
+
+/* Unlocks every resource a process that is going away still holds (they
+ * were locked last, since nothing else ran in between)
+ */
+
+void release_resources(process_t * process) {
+	while ((locked_resources != NULL) && (locked_resources->owner == process)) {
+		unlock_resource(locked_resources);
+	}
+}
+
+/* Returns whether a process that was preempted is still the one to run:
+ * no ready real time process has an earlier deadline, and for a non real
+ * time process nothing else is waiting at all (its time slice is up)
+ */
+
+int keeps_running(process_t * process) {
+	heap_node_t * first = heap_peek(&ready_queue);
+	if (runs_realtime(process)) {
+		return (first == NULL) || (first->key >= process->deadline); //Equal deadlines don't preempt each other
+	}
+	return (first == NULL) && ((process_queue == NULL) || (process->locks > 0)); //Not time sliced in a critical section
+}
+
+/* Asks for a timer interrupt at the next release, at the time the
+ * budget of the running server process or job runs out, or at the next
+ * deadline to enforce (tickless mode)
+ */
+
+void arm_wakeup(void) {
+	tick_t next = next_release;
+	if (current_process->is_cbs && (dispatch_tick + current_process->remaining < next)) {
+		next = dispatch_tick + current_process->remaining;
+	}
+	if (budget_exhausted(current_process, current_process->wcet + 1)) { //The budget is enforced and not spent yet
+		tick_t left = (current_process->used <= current_process->wcet) ? current_process->wcet + 1 - current_process->used : 0;
+		if (dispatch_tick + left < next) {
+			next = dispatch_tick + left;
+		}
+	}
+	if (next_deadline < next) {
+		next = next_deadline;
+	}
+	if (next != TWHEEL_NEVER) {
+		port_timer_wakeup(next);
+	}
+}
+
+/* Moves every process in the not ready queue that has reached its
+ * arrival time to the ready queue (in arrival order), and every sleeping
+ * process that has reached its wakeup time back to its queue
+ */
+
+void release_not_ready_queue(void) {
+	INSTR_START(release_start);
+	twheel_node_t * node = twheel_advance(&not_ready_queue, current_tick);
+	next_release = twheel_next(&not_ready_queue);
+	while (node != NULL) {
+		twheel_node_t * next = node->next;
+		process_t * process = RELEASE_PROCESS(node);
+		if (process->is_cbs) { //A server that wakes up is a new arrival too
+			cbs_arrive(process);
+		}
+		if (process->sleeping) { //Carries on with the same job
+			process->sleeping = 0;
+			TRACE(TRACE_WAKE, process->id, 0);
+		}
+		else {
+			TRACE(TRACE_RELEASE, process->id, release_delay(process));
+			if (process->is_realtime) {
+				release_job(process);
+			}
+		}
+		if (process->is_realtime) {
+			add_ready_queue(process);
+		}
+		else {
+			add_process_queue(process);
+		}
+		node = next;
+	}
+	INSTR_STOP(INSTR_RELEASE, release_start);
+}
+
+/* Adds process to the ready queue (ordered by deadline, first come first served for equal deadlines
+   except for a started basic job) */
+
+void add_ready_queue(process_t * next_process) {
+	INSTR_START(insert_start);
+	next_process->next = NULL;
+	next_process->ready_node.key = next_process->deadline;
+	if (next_process->shared && next_process->job_started) { //A preempted basic job goes back ahead of its equal deadlines, no job may start on its frame
+		heap_insert_first(&ready_queue, &next_process->ready_node);
+	}
+	else {
+		heap_insert(&ready_queue, &next_process->ready_node);
+	}
+	INSTR_STOP(INSTR_INSERT, insert_start);
+}	
+
+/* Removes the process with the earliest deadline from the ready queue and returns it */
+
+process_t * remove_ready_queue(void) {
+	INSTR_START(remove_start);
+	heap_node_t * node = heap_pop(&ready_queue);
+	INSTR_STOP(INSTR_REMOVE, remove_start);
+	if (node == NULL) {
+		return NULL;
+	}
+	else {
+		return READY_PROCESS(node);
+	}
+}
+
+/* Returns the shared stack for a new basic task with a stack of n words
+ * and relative deadline deadline, taking it from the stack pools for the
+ * first one. Returns NULL if the task may not be basic (its budget action
+ * would have it wait behind non real time processes in the middle of a
+ * job), or if the deepest preemption chain would not fit in the shared
+ * stack any more.
+ */
+
+unsigned int * shared_stack_join(int n, tick_t deadline, const rt_attr_t * attr) {
+	unsigned int * stack;
+	if ((attr->budget_action == RT_BUDGET_DEMOTE) && (tick_from_realtime(&attr->wcet) != 0)) {
+		return NULL;
+	}
+	port_irq_disable(); //process_select changes the basic tasks too
+	if (shared_stack_depth(n, deadline) > RT_SHARED_STACK_WORDS + PROCESS_CONTEXT_WORDS) {
+		port_irq_enable();
+		return NULL;
+	}
+	if (shared_stack == NULL) {
+		shared_stack = process_stack_init(NULL, RT_SHARED_STACK_WORDS); //The context it sets up is never used, the jobs get frames of their own
+	}
+	if (shared_stack != NULL) {
+		shared_tasks += 1;
+		shared_level_join(n, deadline);
+	}
+	stack = shared_stack;
+	port_irq_enable();
+	return stack;
+}
+
+/* Returns the most words of shared stack that basic jobs can take at once
+ * if a basic task with a stack of n words and relative deadline deadline
+ * is added. A job only preempts jobs with a later deadline, so it can only
+ * start on top of jobs with longer relative deadlines (as long as no job
+ * is released late, after its arrival time): the deepest chain has one
+ * job of each relative deadline, the one with the largest stack
+ * (shared_levels). Call with interrupts disabled.
+ */
+
+unsigned int shared_stack_depth(int n, tick_t deadline) {
+	shared_level_t * level = shared_level_find(deadline);
+	unsigned int words = n + PROCESS_CONTEXT_WORDS;
+	if (level == NULL) {
+		return shared_depth + words;
+	}
+	return (words > level->words) ? shared_depth - level->words + words : shared_depth;
+}
+
+/* Returns the entry of shared_levels for a relative deadline, NULL if no basic task has it */
+
+shared_level_t * shared_level_find(tick_t deadline) {
+	unsigned int i;
+	for (i = 0; i < shared_level_count; i++) {
+		if (shared_levels[i].deadline == deadline) {
+			return &shared_levels[i];
+		}
+	}
+	return NULL;
+}
+
+/* Counts a basic task with a stack of n words at a relative deadline */
+
+void shared_level_join(int n, tick_t deadline) {
+	shared_level_t * level = shared_level_find(deadline);
+	unsigned int words = n + PROCESS_CONTEXT_WORDS;
+	if (level == NULL) {
+		level = &shared_levels[shared_level_count++]; //A task is at two deadlines at most
+		level->deadline = deadline;
+		level->words = 0;
+		level->tasks = 0;
+	}
+	level->tasks += 1;
+	if (words > level->words) {
+		shared_depth += words - level->words;
+		level->words = words;
+	}
+}
+
+/* Stops counting a basic task at a relative deadline. A level keeps the
+ * largest stack it has had until its last task leaves, which errs on the
+ * safe side and needs no search for the next largest.
+ */
+
+void shared_level_leave(tick_t deadline) {
+	shared_level_t * level = shared_level_find(deadline);
+	if (level == NULL) {
+		return;
+	}
+	level->tasks -= 1;
+	if (level->tasks == 0) {
+		shared_depth -= level->words;
+		*level = shared_levels[--shared_level_count];
+	}
+}
+
+/* Drops the basic jobs at the head of the ready queue whose frame would
+ * not fit on the shared stack below the jobs they preempt. That only
+ * happens when jobs are released late (RT_OVERRUN_CATCHUP), which can
+ * make the chain deeper than shared_stack_depth allows for. Like a stack
+ * overflow, each is counted in process_stack_overflows; the job misses
+ * its deadline instead of running past the bottom of the shared stack.
+ */
+
+void drop_unfit_jobs(void) {
+	heap_node_t * node;
+	while ((node = heap_peek(&ready_queue)) != NULL) {
+		process_t * process = READY_PROCESS(node);
+		if (!process->shared || process->job_started
+				|| process_stack_fits(shared_stack, (shared_frames != NULL) ? shared_frames->sp : NULL, process->stack_size)) {
+			return;
+		}
+		remove_ready_queue();
+		process_stack_overflows += 1;
+		drop_job(process);
+	}
+}
+
+/* Gives a basic job that is about to run for the first time a frame on
+ * the shared stack, right below the stack of the last basic job that
+ * started and has not finished: under EDF that job cannot run again
+ * before this one has finished (it wins ties, see add_ready_queue). The
+ * frame fits, or drop_unfit_jobs would have dropped the job.
+ */
+
+void shared_frame_start(process_t * process) {
+	process->sp = process_stack_frame(shared_stack, (shared_frames != NULL) ? shared_frames->sp : NULL, process->pc);
+	process->older_frame = shared_frames;
+	shared_frames = process;
+}
+
+/* Takes the frame of a basic job that has finished or was dropped off the
+ * shared stack. It is normally the last one that started; one that is
+ * dropped further up leaves a gap, which is used again once the jobs
+ * below it have finished.
+ */
+
+void shared_frame_end(process_t * process) {
+	process_t ** link = &shared_frames;
+	if (!process->job_started) { //It has no frame
+		return;
+	}
+	while ((*link != NULL) && (*link != process)) {
+		link = &(*link)->older_frame;
+	}
+	if (*link != NULL) {
+		*link = process->older_frame;
+	}
+	process->older_frame = NULL;
+}
@@ -1,38 +1,315 @@
-/*************************************************************************
- *
- *  Copyright (c) 2015 Cornell University
- *  Computer Systems Laboratory
- *  Cornell University, Ithaca, NY 14853
- *  All Rights Reserved
- *
- *  $Id$
- *
- **************************************************************************
- */
-
-#ifndef __REALTIME_H__
-#define __REALTIME_H__
-
-typedef struct {
-	unsigned int sec;
-	unsigned int msec;
-} realtime_t;
-
-// The current time relative to process_start
-extern realtime_t current_time;
-
-// The number of processes that have terminated before or after their deadline, respectively.
-extern int process_deadline_met;
-extern int process_deadline_miss;
-
-/* Create a new realtime process out of the function f with the given parameters.
- * Returns -1 if unable to malloc a new process_t, 0 otherwise.
- */
-int process_rt_create(void (*f)(void), int n, realtime_t* start, realtime_t* deadline);
-
-/* Create a new periodic realtime process out of the function f with the given parameters.
- * Returns -1 if unable to malloc a new process_t, 0 otherwise.
- */
-int process_rt_periodic(void (*f)(void), int n, realtime_t *start, realtime_t *deadline, realtime_t *period);
-
-#endif /* __REALTIME_H_INCLUDED */
+/*************************************************************************
+ *
+ *  Copyright (c) 2015 Cornell University
+ *  Computer Systems Laboratory
+ *  Cornell University, Ithaca, NY 14853
+ *  All Rights Reserved
+ *
+ *  $Id$
+ *
+ **************************************************************************
+ */
+
+#ifndef __REALTIME_H__
+#define __REALTIME_H__
+
+#include "rtconfig.h"
+
+typedef struct {
+	unsigned int sec;
+	unsigned int msec;
+} realtime_t;
+
+// The current time relative to process_start
+extern RT_PERCORE realtime_t current_time;
+
+// The number of processes that have terminated before or after their deadline, respectively.
+extern RT_PERCORE int process_deadline_met;
+extern RT_PERCORE int process_deadline_miss;
+
+/* Create a new realtime process out of the function f with the given parameters.
+ * Returns -1 if the process or stack pools (rtconfig.h) are used up, -2 if
+ * it fails admission control (see rt_attr_t), 0 otherwise.
+ */
+int process_rt_create(void (*f)(void), int n, realtime_t* start, realtime_t* deadline);
+
+/* Create a new periodic realtime process out of the function f with the given parameters.
+ * Returns -1 if the process or stack pools (rtconfig.h) are used up, -2 if
+ * it fails admission control (see rt_attr_t), 0 otherwise.
+ */
+int process_rt_periodic(void (*f)(void), int n, realtime_t *start, realtime_t *deadline, realtime_t *period);
+
+/* Create a process served by its own Constant Bandwidth Server, for
+ * aperiodic or soft realtime work. The process arrives at start and is
+ * scheduled by EDF with the server deadline; it may run for budget every
+ * period. Whenever the budget runs out it is refilled and the server
+ * deadline moves one period later, so the process can never take more
+ * than budget / period of the processor away from the other realtime
+ * processes, and it is not starved by them either. The budget is charged
+ * at scheduling points, so it can be overrun by up to one time slice.
+ * The server always goes through admission control with its budget as
+ * the worst-case execution time and its period as the deadline.
+ * Returns -1 if budget is 0 or longer than period, or if the process or
+ * stack pools (rtconfig.h) are used up, -2 if it fails admission control,
+ * 0 otherwise.
+ */
+int process_rt_cbs(void (*f)(void), int n, realtime_t *start, realtime_t *budget, realtime_t *period);
+
+/* Names one process for as long as it exists (see process_handle) */
+typedef unsigned int rt_handle_t;
+
+#define RT_HANDLE_NONE 0 /* never the handle of a process */
+
+/* Overrun policies: what a periodic task does when a job finishes after
+ * the release of the next job
+ */
+#define RT_OVERRUN_CATCHUP 0 /* run every late job in turn, each with its own release and deadline */
+#define RT_OVERRUN_SKIP 1 /* drop the releases that have passed, the next job is the next release not yet past */
+#define RT_OVERRUN_IMMEDIATE 2 /* release the next job right away and measure the following periods from it */
+
+/* Budget actions: what happens to a job that runs for longer than its
+ * declared worst-case execution time
+ */
+#define RT_BUDGET_NONE 0 /* nothing, the budget is not enforced */
+#define RT_BUDGET_DEMOTE 1 /* the job goes on below every realtime process, like a non realtime process, until it finishes */
+#define RT_BUDGET_SUSPEND 2 /* the job is dropped (and counted as a miss); a periodic process waits for its next job, any other process is removed */
+#define RT_BUDGET_HOOK 3 /* the job goes on, only budget_hook is called */
+
+/* Deadline policies: what happens to a job that reaches its deadline
+ * before it finishes
+ */
+#define RT_DEADLINE_HARD 0 /* the job goes on, and counts as a miss when it finishes */
+#define RT_DEADLINE_FIRM 1 /* the job is dropped (and counted as a miss); a periodic process starts over with its next job, any other process is removed */
+#define RT_DEADLINE_SOFT 2 /* the job goes on and counts as a miss when it finishes, deadline_hook is called at the deadline */
+
+/* Optional attributes of a realtime process. Initialize with rt_attr_init
+ * and change the fields that matter before creating the process.
+ *
+ * A process that declares its worst-case execution time goes through EDF
+ * admission control (admit.h): it is only created if every process that
+ * declared one still meets its deadlines, and creation returns -2
+ * otherwise. A process without one is not checked and not counted.
+ *
+ * The worst-case execution time is also the execution budget of every
+ * job. The processor time of a job is counted at every switch, and the
+ * timer interrupt ends the slice of a job the moment it has run for a
+ * tick more than its budget, so budget_action takes effect at once: budget_hook (if any) is
+ * called from the scheduler, with the job as the calling process
+ * (process_id), and then the budget action is taken. A job that holds a
+ * resource is only stopped once it has unlocked it. This keeps a job that
+ * runs away from making the other tasks miss their deadlines.
+ *
+ * The deadline policy decides what a job that is still unfinished at its
+ * deadline is worth. A hard job always runs to the end, however late. For
+ * a firm or soft process a timer fires at the first tick past the
+ * deadline of every job: deadline_hook (if any) is called from the
+ * scheduler with the late job as the calling process (process_id), and a
+ * firm job is then dropped wherever it is, running, ready or asleep, so
+ * that a late result nobody wants takes no more processor time away from
+ * the jobs that can still make their deadlines. The stack of a dropped
+ * periodic job is reset and the process waits for its next release. A
+ * firm job that holds a resource is dropped once it has unlocked it.
+ * Constant bandwidth servers have no hard deadlines and ignore the policy.
+ *
+ * A basic task has no stack of its own: every job runs to completion on
+ * the shared stack (RT_SHARED_STACK_WORDS in rtconfig.h), starting right
+ * below the jobs it preempts, and the stack is left as it was when the
+ * job ends. Under EDF a job only preempts jobs with later deadlines, and
+ * a preempted basic job resumes before the jobs with its deadline start,
+ * so the jobs it preempts cannot run again before it has finished, and
+ * the shared stack only needs room for the deepest chain of jobs that can
+ * preempt each other (one per relative deadline while no job is released
+ * late) rather than a stack per task. Jobs released late
+ * (RT_OVERRUN_CATCHUP) can make the chain deeper: a job whose stack would
+ * not fit is dropped before it starts, as a miss, and counted in
+ * process_stack_overflows. A basic job never waits: process_sleep_until
+ * and the waits of event.h return -1, process_suspend only takes effect
+ * before a job has started or between jobs, and RT_BUDGET_DEMOTE is not
+ * allowed. It may lock resources, since SRP only holds jobs back before
+ * they start. Creating a basic task returns -1 if the deepest chain would
+ * no longer fit in the shared stack; n is still the stack the task needs,
+ * counted in that chain.
+ */
+typedef struct {
+	int overrun; /* the overrun policy of a periodic process (RT_OVERRUN_DEFAULT in rtconfig.h) */
+	realtime_t wcet; /* the worst-case execution time of a job, 0 (the default) for none */
+	int budget_action; /* what happens when a job runs out of budget (RT_BUDGET_DEFAULT in rtconfig.h), only with a wcet */
+	void (* budget_hook)(void); /* called when a job runs out of budget, NULL (the default) for none; keep it short */
+	int deadline_policy; /* what happens when a job reaches its deadline unfinished (RT_DEADLINE_DEFAULT in rtconfig.h) */
+	void (* deadline_hook)(void); /* called when a job of a firm or soft process reaches its deadline unfinished, NULL (the default) for none; keep it short */
+	rt_handle_t * handle; /* where to store the handle of the new process, NULL (the default) for nowhere */
+	int basic; /* whether the jobs run to completion on the shared stack (a basic task), 0 (the default) for a stack of its own */
+} rt_attr_t;
+
+/* Set every attribute to its default */
+void rt_attr_init(rt_attr_t * attr);
+
+/* process_rt_create with attributes (attr may be NULL for the defaults) */
+int process_rt_create_attr(void (*f)(void), int n, realtime_t *start, realtime_t *deadline, const rt_attr_t * attr);
+
+/* process_rt_periodic with attributes (attr may be NULL for the defaults) */
+int process_rt_periodic_attr(void (*f)(void), int n, realtime_t *start, realtime_t *deadline, realtime_t *period,
+	const rt_attr_t * attr);
+
+/* Statistics of the completed jobs of one realtime task, all times in
+ * milliseconds. The start delay of a job is the time from its arrival to
+ * the first time it runs; the release jitter is the spread between the
+ * smallest and largest start delay (meaningful for periodic tasks).
+ */
+typedef struct {
+	unsigned int jobs; /* the number of jobs that have finished */
+	unsigned int misses; /* the number of those that finished after their deadline */
+	unsigned int response_max; /* the longest time from arrival to finishing */
+	unsigned int response_avg; /* the average time from arrival to finishing */
+	int lateness_max; /* the latest finish relative to the deadline, negative if every job was early */
+	unsigned int start_delay_max; /* the longest start delay */
+	unsigned int jitter; /* the largest start delay minus the smallest */
+	unsigned int preemptions; /* the number of times a job was switched out before finishing */
+	unsigned int skipped; /* the number of periodic releases dropped by RT_OVERRUN_SKIP */
+	unsigned int overruns; /* the number of jobs that ran out of their execution budget */
+	unsigned int aborts; /* the number of jobs dropped at their deadline (RT_DEADLINE_FIRM), also counted in jobs and misses */
+} process_rt_stats_t;
+
+/* Get the statistics of the realtime task(s) created from the function f.
+ * Statistics are kept per function for up to RT_MAX_TASK_STATS functions
+ * (rtconfig.h) and survive the processes and process_start, until
+ * process_rt_stats_reset.
+ * Returns -1 if f has no statistics, 0 otherwise.
+ */
+int process_rt_stats(void (*f)(void), process_rt_stats_t * stats);
+
+/* Clear the statistics of every task. The functions that no process runs
+ * any more lose their entries, which makes room for new functions.
+ */
+void process_rt_stats_reset(void);
+
+/* A resource shared between processes, locked under the Stack Resource
+ * Policy. The preemption level of a realtime process is its relative
+ * deadline (shorter is higher), and the ceiling of a resource is the
+ * shortest relative deadline of any process that locks it. While
+ * resources are locked, a job that has not started yet may only start
+ * if its relative deadline is shorter than every locked ceiling;
+ * otherwise it waits in the ready queue, even if its absolute deadline
+ * is the earliest. So a lock never has to wait: every resource a job
+ * needs is free by the time it starts. Each job is blocked by at most
+ * one critical section of a job with a longer relative deadline, nested
+ * locks cannot deadlock, and jobs that share resources never wait in the
+ * middle of a job.
+ *
+ * Non realtime processes rank below every realtime process and are not
+ * time sliced while they hold a resource. Locks must be released in the
+ * reverse order they were taken, and a job still holding resources when
+ * it finishes releases them.
+ */
+typedef struct rt_resource {
+	unsigned long long ceiling; /* the shortest relative deadline of the processes that lock it, in ticks */
+	unsigned long long ceiling_below; /* the system ceiling from before it was locked */
+	struct process_state * owner; /* the process holding it, NULL if it is free */
+	struct rt_resource * below; /* the resource locked before it */
+} rt_resource_t;
+
+/* Initialize a free resource. ceiling must be no longer than the relative
+ * deadline of any realtime process that locks it.
+ */
+void rt_resource_init(rt_resource_t * resource, realtime_t * ceiling);
+
+/* Lock a resource. This never waits. Returns -1 if the resource is
+ * already held or its ceiling is longer than the relative deadline of the
+ * caller (both mean the ceiling is wrong), 0 otherwise.
+ */
+int process_rt_lock(rt_resource_t * resource);
+
+/* Unlock the resource the caller locked last. Any job that it held back
+ * and that has an earlier deadline runs right away. Returns -1 if the
+ * resource is not the last one the caller locked, 0 otherwise.
+ */
+int process_rt_unlock(rt_resource_t * resource);
+
+/* Sleeping.
+ *
+ * A process that sleeps gives up the processor until its wakeup time:
+ * it waits in the not ready queue, other processes run (or the processor
+ * idles) meanwhile, and it is made ready again at the first tick at or
+ * after the wakeup time. Unlike delay() in utils.c, this leaves the time
+ * to lower priority work. A realtime job keeps its deadline while it
+ * sleeps, so the sleep counts against its response time.
+ *
+ * Both calls work for any process but basic tasks. They return -1 if the
+ * caller holds a resource (a job may not wait while it holds one) or is a
+ * basic task, 0 otherwise, right away if the wakeup time has already
+ * passed.
+ */
+
+/* Sleep until current_time reaches when */
+int process_sleep_until(realtime_t * when);
+
+/* Sleep for time */
+int process_sleep_for(realtime_t * time);
+
+/* Task management.
+ *
+ * Every process has a handle, which the creating code gets through
+ * rt_attr_t.handle and a process gets for itself from process_handle().
+ * A handle is an index into a table with a slot per process struct
+ * (RT_MAX_PROCESSES in rtconfig.h), so every call below finds its process
+ * in constant time. The slot also counts the processes it has held, so
+ * the handle of a process that has finished or been killed stops working
+ * (the calls return -1) even once its struct holds a new process.
+ *
+ * Changes take effect at job boundaries, so no job is cut short or runs
+ * with a mix of old and new parameters:
+ * - A periodic process is suspended when its current job finishes (right
+ *   away if it is waiting for its next release). When it is resumed it
+ *   waits for the first of its releases that has not passed yet; the ones
+ *   in between are not made up for.
+ * - Any other process is suspended right away, or as soon as it holds no
+ *   resource, and goes on where it was when it is resumed. A firm job
+ *   whose deadline passed in the meantime is dropped then.
+ * - A process is killed right away, or as soon as it holds no resource.
+ *   Its job is not counted.
+ * - A new period or relative deadline applies from the next release of
+ *   the process on (a release that is already due keeps the old values).
+ *   A process that declared its worst-case execution time goes through
+ *   admission control again with the new values first. A new relative
+ *   deadline must not be shorter than the ceiling of a resource the
+ *   process locks.
+ *
+ * A suspended process still holds its admitted share of the processor,
+ * and process_start keeps waiting for it to be resumed or killed (or for
+ * process_stop). Call these from processes, not from interrupt handlers.
+ */
+
+/* Get the handle of the calling process */
+rt_handle_t process_handle(void);
+
+/* Suspend a process (the caller too). Suspending a suspended process does
+ * nothing. Returns -1 if the handle names no process, 0 otherwise.
+ */
+int process_suspend(rt_handle_t handle);
+
+/* Resume a suspended process, or cancel a suspension that has not taken
+ * effect yet. Resuming a process that is not suspended does nothing.
+ * Returns -1 if the handle names no process, 0 otherwise.
+ */
+int process_resume(rt_handle_t handle);
+
+/* Kill a process (the caller too, then it does not return). Returns -1 if
+ * the handle names no process, 0 otherwise.
+ */
+int process_kill(rt_handle_t handle);
+
+/* Change the period of a periodic process. Returns -1 if the handle names
+ * no periodic process (constant bandwidth servers included) or the
+ * period is 0, -2 if the new period fails admission control, 0 otherwise.
+ */
+int process_set_period(rt_handle_t handle, realtime_t * period);
+
+/* Change the relative deadline of a realtime process. Returns -1 if the
+ * handle names no realtime process (constant bandwidth servers included),
+ * the deadline is 0 or the preemption chain of basic tasks would no
+ * longer fit in the shared stack, -2 if the new deadline fails admission
+ * control, 0 otherwise.
+ */
+int process_set_deadline(rt_handle_t handle, realtime_t * deadline);
+
+#endif /* __REALTIME_H_INCLUDED */
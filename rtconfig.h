@@ -0,0 +1,147 @@
+#ifndef __RTCONFIG_H__
+#define __RTCONFIG_H__
+
+/* Compile-time sizes of the scheduler's static memory pools. Every value
+ * can be overridden from the compiler command line (-D) to fit the part.
+ */
+
+/* Storage class of the scheduler state. In the multicore host build
+ * (RT_HOST and RT_MULTICORE, see multicore.h) every simulated core is a
+ * thread with its own copy of the state, and so its own scheduler.
+ */
+#ifdef RT_MULTICORE
+#ifndef RT_HOST
+#error "RT_MULTICORE is only for the host simulation backend (RT_HOST)"
+#endif
+#define RT_PERCORE __thread
+#else
+#define RT_PERCORE
+#endif
+
+/* The most processes (of any kind) that can exist at once */
+#ifndef RT_MAX_PROCESSES
+#define RT_MAX_PROCESSES 16
+#endif
+
+/* The length of a time slice in ms. PIT0 interrupts this often to share
+ * the processor between the non real time processes (round robin); real
+ * time processes are only preempted by releases.
+ */
+#ifndef RT_SLICE_MS
+#define RT_SLICE_MS 10
+#endif
+
+/* Whether a release of a process with an earlier deadline than the
+ * running one preempts it at once (1), or only at the next PIT0 tick (0,
+ * the old behaviour, which delays it by up to RT_SLICE_MS)
+ */
+#ifndef RT_EVENT_PREEMPT
+#define RT_EVENT_PREEMPT 1
+#endif
+
+/* The most task functions that job statistics are kept for (see process_rt_stats) */
+#ifndef RT_MAX_TASK_STATS
+#define RT_MAX_TASK_STATS RT_MAX_PROCESSES
+#endif
+
+/* What a periodic task does by default when a job finishes after the
+ * next release (RT_OVERRUN_CATCHUP, RT_OVERRUN_SKIP or
+ * RT_OVERRUN_IMMEDIATE from realtime.h, see rt_attr_t)
+ */
+#ifndef RT_OVERRUN_DEFAULT
+#define RT_OVERRUN_DEFAULT RT_OVERRUN_CATCHUP
+#endif
+
+/* What happens to a job that runs longer than its worst-case execution
+ * time, unless set per process (RT_BUDGET_NONE, RT_BUDGET_DEMOTE,
+ * RT_BUDGET_SUSPEND or RT_BUDGET_HOOK from realtime.h, see rt_attr_t)
+ */
+#ifndef RT_BUDGET_DEFAULT
+#define RT_BUDGET_DEFAULT RT_BUDGET_NONE
+#endif
+
+/* What happens to a job that is unfinished at its deadline, unless set
+ * per process (RT_DEADLINE_HARD, RT_DEADLINE_FIRM or RT_DEADLINE_SOFT
+ * from realtime.h, see rt_attr_t)
+ */
+#ifndef RT_DEADLINE_DEFAULT
+#define RT_DEADLINE_DEFAULT RT_DEADLINE_HARD
+#endif
+
+/* The most steps the EDF processor demand test may take before admission
+ * control gives up and refuses a task (see admit.h). Each step looks at
+ * every admitted task.
+ */
+#ifndef RT_ADMIT_MAX_STEPS
+#define RT_ADMIT_MAX_STEPS 10000
+#endif
+
+/* Whether process_select checks the guard word at the bottom of the stack
+ * of the process it switches out (1) and stops a process that has run past
+ * it, or trusts the stack sizes (0)
+ */
+#ifndef RT_STACK_CHECK
+#define RT_STACK_CHECK 1
+#endif
+
+/* Whether the most stack each task function uses is kept for
+ * process_stack_profile (1). This scans the paint of the stack of every
+ * process switched out, so it is meant for profiling runs.
+ */
+#ifndef RT_STACK_PROFILE
+#define RT_STACK_PROFILE 0
+#endif
+
+/* The number of records the RT_TRACE scheduling trace ring holds (see
+ * trace.h), a power of two. Each record takes 8 bytes.
+ */
+#ifndef RT_TRACE_SIZE
+#define RT_TRACE_SIZE 512
+#endif
+
+/* Stack size classes. A process created with a stack of n words gets a
+ * block from the smallest class of at least n + 18 words (17 words hold
+ * the saved context and one the guard word), or a larger class if that
+ * one is used up. Processes that use the FPU need 34 more words in n.
+ */
+#define RT_STACK_CLASSES 4
+
+#ifndef RT_STACK_WORDS_0
+#define RT_STACK_WORDS_0 64
+#endif
+#ifndef RT_STACK_COUNT_0
+#define RT_STACK_COUNT_0 8
+#endif
+
+#ifndef RT_STACK_WORDS_1
+#define RT_STACK_WORDS_1 128
+#endif
+#ifndef RT_STACK_COUNT_1
+#define RT_STACK_COUNT_1 8
+#endif
+
+#ifndef RT_STACK_WORDS_2
+#define RT_STACK_WORDS_2 256
+#endif
+#ifndef RT_STACK_COUNT_2
+#define RT_STACK_COUNT_2 4
+#endif
+
+#ifndef RT_STACK_WORDS_3
+#define RT_STACK_WORDS_3 512
+#endif
+#ifndef RT_STACK_COUNT_3
+#define RT_STACK_COUNT_3 2
+#endif
+
+/* The stack that the jobs of basic tasks (rt_attr_t.basic) share, in
+ * words besides one saved context. It is taken from the stack classes
+ * above when the first basic task is created. A basic task is only
+ * created if the deepest chain of basic jobs that can preempt each other
+ * fits; a job released late that would not fit is dropped instead.
+ */
+#ifndef RT_SHARED_STACK_WORDS
+#define RT_SHARED_STACK_WORDS 200
+#endif
+
+#endif
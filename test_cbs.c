@@ -0,0 +1,116 @@
+/* Host-side tests of the Constant Bandwidth Server (process_rt_cbs).
+ *
+ * Runs server processes next to hard realtime processes on the host
+ * simulation backend and checks that a server runs out of budget, gets
+ * its deadline postponed and its budget refilled, that the hard processes
+ * keep their deadlines, and that background work still gets its share.
+ *
+ * Build and run on the host:
+ *   gcc -DRT_HOST -o test_cbs test_cbs.c test_util.c process.c 3140_host.c heap.c twheel.c tick.c pool.c instr.c admit.c trace.c && ./test_cbs
+ * Prints every failed check and exits with the number of failures.
+ */
+
+#include <stdio.h>
+#include "3140_concur.h"
+#include "realtime.h"
+#include "host.h"
+#include "test_util.h"
+
+#define RT_STACK 80
+
+/*-------------------------------------------------------------
+ * Budget exhaustion: the server gives way to a hard process once its
+ * budget runs out twice and its deadline passes the hard deadline
+ *-------------------------------------------------------------*/
+
+static void exhaust_server(void) {
+	log_event('S', 1);
+	host_run(300);
+	log_event('E', 1);
+}
+
+static void exhaust_hard(void) {
+	log_event('S', 2);
+	host_run(1000);
+	log_event('E', 2);
+}
+
+static void test_exhaustion(void) {
+	realtime_t start = {0, 0};
+	realtime_t hard_deadline = {1, 400};
+	realtime_t budget = {0, 100};
+	realtime_t period = {0, 500};
+	process_rt_stats_t stats;
+	reset();
+	CHECK(process_rt_create(exhaust_hard, RT_STACK, &start, &hard_deadline) == 0);
+	CHECK(process_rt_cbs(exhaust_server, RT_STACK, &start, &budget, &period) == 0);
+	process_start();
+	CHECK(event_count == 4);
+	CHECK(events[0].what == 'S' && events[0].who == 1 && events[0].when == 0); //Server deadline 500 is first
+	CHECK(events[1].what == 'S' && events[1].who == 2 && events[1].when == 200); //Two budgets later the server deadline is 1500, after the hard one
+	CHECK(events[2].what == 'E' && events[2].who == 2 && events[2].when == 1200);
+	CHECK(events[3].what == 'E' && events[3].who == 1 && events[3].when == 1300);
+	CHECK(process_deadline_met == 1); //Only the hard process counts
+	CHECK(process_deadline_miss == 0);
+	CHECK(process_rt_stats(exhaust_server, &stats) == 0);
+	CHECK(stats.jobs == 1 && stats.preemptions == 1);
+}
+
+/*-------------------------------------------------------------
+ * Replenishment: long background work next to a 70% periodic load keeps
+ * running on refilled budgets without making the periodic process late
+ *-------------------------------------------------------------*/
+
+static void load_server(void) {
+	log_event('S', 1);
+	host_run(2900);
+	log_event('E', 1);
+}
+
+static void load_hard(void) {
+	host_run(700);
+}
+
+static void test_replenishment(void) {
+	realtime_t start = {0, 0};
+	realtime_t t_1sec = {1, 0};
+	realtime_t hard_deadline = {0, 900};
+	realtime_t budget = {0, 200};
+	process_rt_stats_t stats;
+	reset();
+	CHECK(process_rt_periodic(load_hard, RT_STACK, &start, &hard_deadline, &t_1sec) == 0);
+	CHECK(process_rt_cbs(load_server, RT_STACK, &start, &budget, &t_1sec) == 0);
+	host_stop_at(12000);
+	process_start();
+	host_stop_at(0);
+	CHECK(process_deadline_miss == 0);
+	CHECK(process_deadline_met == 12);
+	CHECK(event_count == 2);
+	CHECK(events[0].when == 700); //After the first periodic job
+	CHECK(events[1].when == 9900); //Gets the 300 ms the periodic process leaves every period
+	CHECK(process_rt_stats(load_server, &stats) == 0);
+	CHECK(stats.jobs == 1 && stats.preemptions == 9);
+}
+
+/*-------------------------------------------------------------
+ * Bad server parameters
+ *-------------------------------------------------------------*/
+
+static void test_parameters(void) {
+	realtime_t start = {0, 0};
+	realtime_t zero = {0, 0};
+	realtime_t budget = {0, 600};
+	realtime_t period = {0, 500};
+	CHECK(process_rt_cbs(load_server, RT_STACK, &start, &zero, &period) == -1);
+	CHECK(process_rt_cbs(load_server, RT_STACK, &start, &budget, &period) == -1); //More than 100% bandwidth
+}
+
+int main(void) {
+	test_exhaustion();
+	test_replenishment();
+	test_parameters();
+	if (failures == 0) {
+		printf("test_cbs: all checks passed\n");
+	}
+	return failures;
+}
@@ -0,0 +1,281 @@
+/* Host-side tests of the message queues and event flags (event.h).
+ *
+ * Simulated device interrupts (host_interrupt_at) post to queues and set
+ * flags, and the tests check that the waiting processes wake up as
+ * sporadic jobs with their deadlines counted from the post, that the
+ * earliest deadline runs first, and how long it takes from a post to the
+ * dispatch of the job it releases while other work is running (the
+ * reported worst is 0 ms with RT_EVENT_PREEMPT and up to a PIT0 period
+ * without).
+ *
+ * Build and run on the host:
+ *   gcc -DRT_HOST -o test_event test_event.c test_util.c event.c process.c 3140_host.c heap.c twheel.c tick.c pool.c instr.c admit.c trace.c && ./test_event
+ * Prints every failed check and exits with the number of failures.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "3140_concur.h"
+#include "realtime.h"
+#include "event.h"
+#include "host.h"
+#include "test_util.h"
+#include "rtconfig.h"
+
+#define RT_STACK 80
+
+static rt_queue_t queue;
+static unsigned int queue_buffer[4];
+static rt_queue_t queue_2;
+static unsigned int queue_2_buffer[4];
+static rt_flags_t flags;
+static unsigned int next_message;
+
+static void post_isr(void) {
+	CHECK(rt_queue_post(&queue, &next_message) == 0);
+	next_message++;
+}
+
+static void post_2_isr(void) {
+	unsigned int message = 2;
+	CHECK(rt_queue_post(&queue_2, &message) == 0);
+}
+
+static void background(void) {
+	while (1) {
+		host_run(1);
+	}
+}
+
+/*-------------------------------------------------------------
+ * A process that waits on a queue runs a job per message; messages
+ * posted while it runs wait in the queue
+ *-------------------------------------------------------------*/
+
+static void sporadic(void) {
+	unsigned int message;
+	int i;
+	for (i = 0; i < 3; i++) {
+		CHECK(rt_queue_receive(&queue, &message) == 0);
+		log_event(message, 1);
+		host_run(5);
+	}
+}
+
+static void test_sporadic(void) {
+	realtime_t start = {0, 0};
+	realtime_t deadline = {0, 50};
+	process_rt_stats_t stats;
+	reset();
+	next_message = 1;
+	CHECK(rt_queue_init(&queue, queue_buffer, sizeof(unsigned int), 4) == 0);
+	CHECK(host_interrupt_at(100, post_isr) == 0);
+	CHECK(host_interrupt_at(200, post_isr) == 0);
+	CHECK(host_interrupt_at(203, post_isr) == 0); //While the job of the second message runs
+	CHECK(process_rt_create(sporadic, RT_STACK, &start, &deadline) == 0);
+	process_start();
+	CHECK(event_count == 3);
+	CHECK(events[0].what == 1 && events[0].when == 100);
+	CHECK(events[1].what == 2 && events[1].when == 200);
+	CHECK(events[2].what == 3 && events[2].when == 205); //Right away, it was already there
+	CHECK(process_deadline_met == 3); //The job before the first wait and one job per wakeup
+	CHECK(process_deadline_miss == 0);
+	CHECK(process_rt_stats(sporadic, &stats) == 0);
+	CHECK(stats.jobs == 3);
+	CHECK(stats.start_delay_max == 0);
+	CHECK(stats.response_max == 10); //Counted from the post, the third message went with the second job
+}
+
+/*-------------------------------------------------------------
+ * Two posts at once release jobs that run by deadline, ahead of a
+ * running job with a later deadline; the deadline of each is relative
+ * to the post
+ *-------------------------------------------------------------*/
+
+static void urgent(void) {
+	unsigned int message;
+	CHECK(rt_queue_receive(&queue, &message) == 0);
+	log_event(message, 1);
+	host_run(10);
+	log_event(0, 1);
+}
+
+static void relaxed(void) {
+	unsigned int message;
+	CHECK(rt_queue_receive(&queue_2, &message) == 0);
+	log_event(message, 2);
+	host_run(10);
+	log_event(0, 2);
+}
+
+static void long_job(void) {
+	log_event(0, 3);
+	host_run(200);
+	log_event(0, 3);
+}
+
+static void test_priority(void) {
+	realtime_t start = {0, 0};
+	realtime_t urgent_deadline = {0, 20};
+	realtime_t relaxed_deadline = {0, 100};
+	realtime_t long_deadline = {1, 0};
+	reset();
+	next_message = 1;
+	CHECK(rt_queue_init(&queue, queue_buffer, sizeof(unsigned int), 4) == 0);
+	CHECK(rt_queue_init(&queue_2, queue_2_buffer, sizeof(unsigned int), 4) == 0);
+	CHECK(host_interrupt_at(100, post_2_isr) == 0);
+	CHECK(host_interrupt_at(100, post_isr) == 0);
+	CHECK(process_rt_create(relaxed, RT_STACK, &start, &relaxed_deadline) == 0);
+	CHECK(process_rt_create(urgent, RT_STACK, &start, &urgent_deadline) == 0);
+	CHECK(process_rt_create(long_job, RT_STACK, &start, &long_deadline) == 0);
+	process_start();
+	CHECK(process_deadline_met == 5);
+	CHECK(event_count == 6);
+	CHECK(events[0].who == 3 && events[0].when == 0);
+	CHECK(events[1].who == 1 && events[1].what == 1 && events[1].when == 100);
+	CHECK(events[2].who == 1 && events[2].when == 110);
+	CHECK(events[3].who == 2 && events[3].what == 2 && events[3].when == 110);
+	CHECK(events[4].who == 2 && events[4].when == 120);
+	CHECK(events[5].who == 3 && events[5].when == 220);
+}
+
+/*-------------------------------------------------------------
+ * Event flags: a wait for all flags sleeps through a partial set, a
+ * wait for any wakes on the first, and the flags it got are cleared
+ *-------------------------------------------------------------*/
+
+static void set_1_isr(void) {
+	rt_flags_set(&flags, 0x1);
+}
+
+static void set_2_isr(void) {
+	rt_flags_set(&flags, 0x2);
+}
+
+static void set_c_isr(void) {
+	rt_flags_set(&flags, 0xC);
+}
+
+static void flag_waiter(void) {
+	unsigned int got;
+	CHECK(rt_flags_wait(&flags, 0x3, 1, &got) == 0);
+	log_event(got, 1);
+	CHECK(rt_flags_wait(&flags, 0x6, 0, &got) == 0);
+	log_event(got, 1);
+}
+
+static void test_flags(void) {
+	reset();
+	rt_flags_init(&flags);
+	CHECK(host_interrupt_at(50, set_1_isr) == 0);
+	CHECK(host_interrupt_at(80, set_2_isr) == 0);
+	CHECK(host_interrupt_at(120, set_c_isr) == 0);
+	CHECK(process_create(flag_waiter, RT_STACK) == 0); //Non real time processes wait the same way
+	process_start();
+	CHECK(event_count == 2);
+	CHECK(events[0].what == 0x3 && events[0].when == 80);
+	CHECK(events[1].what == 0x4 && events[1].when == 120);
+	CHECK(flags.flags == 0x8); //Not waited for, still set
+}
+
+/*-------------------------------------------------------------
+ * Limits: a full queue refuses posts, capacities must be powers of two,
+ * and a periodic process may not wait
+ *-------------------------------------------------------------*/
+
+static void periodic_receiver(void) {
+	unsigned int message;
+	CHECK(rt_queue_receive(&queue, &message) == -1);
+}
+
+static void test_limits(void) {
+	realtime_t start = {0, 0};
+	realtime_t period = {0, 100};
+	unsigned int message = 7, i;
+	CHECK(rt_queue_init(&queue, queue_buffer, sizeof(unsigned int), 3) == -1);
+	CHECK(rt_queue_init(&queue, queue_buffer, sizeof(unsigned int), 4) == 0);
+	CHECK(rt_queue_try_receive(&queue, &message) == -1);
+	for (i = 0; i < 4; i++) {
+		CHECK(rt_queue_post(&queue, &i) == 0);
+	}
+	CHECK(rt_queue_post(&queue, &i) == -1);
+	for (i = 0; i < 4; i++) {
+		CHECK(rt_queue_try_receive(&queue, &message) == 0 && message == i);
+	}
+	reset();
+	host_stop_at(250);
+	CHECK(process_rt_periodic(periodic_receiver, RT_STACK, &start, &period, &period) == 0);
+	process_start();
+	host_stop_at(0);
+	CHECK(process_deadline_met == 3);
+}
+
+/*-------------------------------------------------------------
+ * Latency from a post to the dispatch of its job while non real time
+ * work and a periodic task keep the processor busy
+ *-------------------------------------------------------------*/
+
+#define LATENCY_POSTS 200
+
+static void handler(void) {
+	unsigned int message;
+	while (rt_queue_receive(&queue, &message) == 0) {
+		host_run(1);
+	}
+}
+
+static void periodic_load(void) {
+	host_run(30);
+}
+
+static int posts_left;
+
+/* A device that interrupts at random intervals */
+
+static void device_isr(void) {
+	post_isr();
+	if (--posts_left > 0) {
+		CHECK(host_interrupt_at(host_time() + 3 + rand() % 20, device_isr) == 0);
+	}
+}
+
+static void test_latency(void) {
+	realtime_t start = {0, 0};
+	realtime_t deadline = {0, 5};
+	realtime_t load_deadline = {0, 100};
+	process_rt_stats_t stats;
+	reset();
+	srand(1);
+	posts_left = LATENCY_POSTS;
+	CHECK(rt_queue_init(&queue, queue_buffer, sizeof(unsigned int), 4) == 0);
+	CHECK(host_interrupt_at(10, device_isr) == 0);
+	CHECK(process_rt_create(handler, RT_STACK, &start, &deadline) == 0);
+	CHECK(process_rt_periodic(periodic_load, RT_STACK, &start, &load_deadline, &load_deadline) == 0);
+	CHECK(process_create(background, RT_STACK) == 0);
+	host_stop_at(25 * LATENCY_POSTS);
+	process_start();
+	host_stop_at(0);
+	CHECK(posts_left == 0);
+	CHECK(process_rt_stats(handler, &stats) == 0);
+	CHECK(stats.jobs == LATENCY_POSTS + 1); //Every post finds it waiting, plus the job before the first wait
+	CHECK(stats.misses == 0);
+#if RT_EVENT_PREEMPT
+	CHECK(stats.start_delay_max == 0);
+#else
+	CHECK(stats.start_delay_max <= RT_SLICE_MS);
+#endif
+	printf("test_event: worst post to dispatch delay %u ms over %u jobs (RT_EVENT_PREEMPT %d)\n",
+		(unsigned int) stats.start_delay_max, stats.jobs, RT_EVENT_PREEMPT);
+}
+
+int main(void) {
+	test_sporadic();
+	test_priority();
+	test_flags();
+	test_limits();
+	test_latency();
+	if (failures == 0) {
+		printf("test_event: all checks passed\n");
+	}
+	return failures;
+}
@@ -0,0 +1,1332 @@
+/* Host-side scheduling tests, run on the host simulation backend.
+ *
+ * Replays the board tests test_r1.c, test_r2.c and test_p1.c with
+ * host_run() standing in for delay() (one shortDelay() is taken to be
+ * 100 ms), checks the order the jobs run in and the deadline counters
+ * instead of watching the LEDs, and then reports how many scenarios per
+ * second the simulation runs, the scheduler cost per switch, how many
+ * PIT0 ticks skipped the scheduler and the worst delay from the release
+ * of a job to the time it runs (build with -DRT_EVENT_PREEMPT=0 for the
+ * delay with preemption at PIT0 ticks only).
+ *
+ * Build and run on the host:
+ *   gcc -DRT_HOST -o test_host test_host.c test_util.c process.c 3140_host.c heap.c twheel.c tick.c pool.c instr.c admit.c trace.c && ./test_host
+ * Prints every failed check and exits with the number of failures. Add
+ * -DRT_INSTRUMENT to also dump the per-path overhead of the last scenario,
+ * and -DRT_TRACE to check the scheduling trace and write the trace of an
+ * overrunning periodic task to test_host.trace (see trace_decode.c).
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "3140_concur.h"
+#include "realtime.h"
+#include "host.h"
+#include "test_util.h"
+#include "instr.h"
+#include "rtconfig.h"
+#include "trace.h"
+
+#define RT_STACK 80
+
+#define SHORT_DELAY 100 /* ms of simulated work for one shortDelay() */
+#define MEDIUM_DELAY (2 * SHORT_DELAY)
+
+/*-------------------------------------------------------------
+ * test_r1: pRT2 arrives later with an earlier deadline and preempts pRT1
+ *-------------------------------------------------------------*/
+
+static void r1_pRT1(void) {
+	log_event('S', 1);
+	host_run(20 * 2 * SHORT_DELAY);
+	log_event('E', 1);
+}
+
+static void r1_pRT2(void) {
+	log_event('S', 2);
+	host_run(10 * 2 * MEDIUM_DELAY);
+	log_event('E', 2);
+}
+
+static void test_r1(void) {
+	realtime_t t_2sec = {2, 0};
+	realtime_t t_10sec = {10, 0};
+	realtime_t t_pRT1 = {0, 1};
+	realtime_t t_pRT2 = {1, 0};
+	process_rt_stats_t stats;
+	reset();
+	CHECK(process_rt_create(r1_pRT1, RT_STACK, &t_pRT1, &t_10sec) == 0);
+	CHECK(process_rt_create(r1_pRT2, RT_STACK, &t_pRT2, &t_2sec) == 0);
+	process_start();
+	CHECK(event_count == 4);
+	CHECK(events[0].what == 'S' && events[0].who == 1 && events[0].when == 1);
+	CHECK(events[1].what == 'S' && events[1].who == 2 && events[1].when == 1000); //Preempts pRT1 on release
+	CHECK(events[2].what == 'E' && events[2].who == 2);
+	CHECK(events[3].what == 'E' && events[3].who == 1);
+	CHECK(process_deadline_met == 1); //pRT1
+	CHECK(process_deadline_miss == 1); //pRT2 needs 4 s but only has 2 s
+	CHECK(process_rt_stats(r1_pRT1, &stats) == 0);
+	CHECK(stats.jobs == 1 && stats.misses == 0);
+	CHECK(stats.preemptions == 1); //By pRT2
+	CHECK(stats.response_max == events[3].when - 1);
+	CHECK(stats.lateness_max == (int) events[3].when - 10001);
+	CHECK(process_rt_stats(r1_pRT2, &stats) == 0);
+	CHECK(stats.jobs == 1 && stats.misses == 1);
+	CHECK(stats.preemptions == 0);
+	CHECK(stats.start_delay_max == 0);
+	CHECK(stats.response_max == events[2].when - 1000);
+	CHECK(stats.lateness_max == (int) events[2].when - 3000);
+	CHECK(process_rt_stats(test_r1, &stats) == -1); //Not a task
+}
+
+/*-------------------------------------------------------------
+ * test_r2: equal relative deadlines, pRT1 arrives first and runs first
+ *-------------------------------------------------------------*/
+
+static void r2_pRT1(void) {
+	log_event('S', 1);
+	host_run(4 * 2 * MEDIUM_DELAY);
+	log_event('E', 1);
+}
+
+static void r2_pRT2(void) {
+	log_event('S', 2);
+	host_run(3 * 2 * MEDIUM_DELAY);
+	log_event('E', 2);
+}
+
+static void run_r2(void) {
+	realtime_t t_5sec = {5, 0};
+	realtime_t t_pRT1 = {0, 1};
+	realtime_t t_pRT2 = {1, 0};
+	reset();
+	process_rt_create(r2_pRT1, RT_STACK, &t_pRT1, &t_5sec);
+	process_rt_create(r2_pRT2, RT_STACK, &t_pRT2, &t_5sec);
+	process_start();
+}
+
+static void test_r2(void) {
+	run_r2();
+	CHECK(event_count == 4);
+	CHECK(events[0].what == 'S' && events[0].who == 1);
+	CHECK(events[1].what == 'E' && events[1].who == 1 && events[1].when == 1601);
+	CHECK(events[2].what == 'S' && events[2].who == 2);
+	CHECK(events[3].what == 'E' && events[3].who == 2 && events[3].when == 2801);
+	CHECK(process_deadline_met == 2);
+	CHECK(process_deadline_miss == 0);
+}
+
+/*-------------------------------------------------------------
+ * test_p1: two periodic tasks with a 10 s period alternate forever
+ *-------------------------------------------------------------*/
+
+static void p1_pRT1(void) {
+	log_event('S', 1);
+	host_run(3 * 2 * MEDIUM_DELAY);
+	log_event('E', 1);
+}
+
+static void p1_pRT2(void) {
+	log_event('S', 2);
+	host_run(3 * 2 * MEDIUM_DELAY);
+	log_event('E', 2);
+}
+
+static void test_p1(void) {
+	realtime_t t_10sec = {10, 0};
+	realtime_t t_period = {10, 0};
+	realtime_t t_pRT1 = {0, 1};
+	realtime_t t_pRT2 = {1, 0};
+	pool_stats_t stats;
+	process_rt_stats_t rt_stats;
+	int i;
+	reset();
+	CHECK(process_rt_periodic(p1_pRT1, RT_STACK, &t_pRT1, &t_10sec, &t_period) == 0);
+	CHECK(process_rt_periodic(p1_pRT2, RT_STACK, &t_pRT2, &t_10sec, &t_period) == 0);
+	host_stop_at(60000); //Six periods
+	process_start();
+	host_stop_at(0);
+	CHECK(event_count == 24);
+	for (i = 0; i < event_count; i++) {
+		CHECK(events[i].who == ((i / 2) % 2) + 1); //Blue then red, every period
+		CHECK(events[i].what == ((i % 2) ? 'E' : 'S'));
+	}
+	CHECK(events[4].when == 10001); //pRT1's second release
+	CHECK(process_deadline_met == 12);
+	CHECK(process_deadline_miss == 0);
+	CHECK(process_pool_stats(0, &stats) == 0);
+	CHECK(stats.used == 0); //process_stop gave everything back
+	CHECK(stats.high_water >= 2);
+	CHECK(process_rt_stats(p1_pRT2, &rt_stats) == 0);
+	CHECK(rt_stats.jobs == 6 && rt_stats.misses == 0);
+	CHECK(rt_stats.start_delay_max == events[2].when - 1000); //Waits for pRT1 every period
+	CHECK(rt_stats.jitter <= 1);
+	CHECK(rt_stats.response_avg >= rt_stats.start_delay_max + 1200 - 1);
+	CHECK(rt_stats.lateness_max < 0);
+}
+
+/*-------------------------------------------------------------
+ * Periodic re-arming: exact deadlines and the overrun policies
+ *-------------------------------------------------------------*/
+
+static int overrun_work; /* ms each job of the overrun task runs for */
+
+static void overrun_task(void) {
+	log_event('S', 1);
+	host_run(overrun_work);
+	log_event('E', 1);
+}
+
+/* Runs overrun_task with a 1 s period and relative deadline for 10 s */
+
+static void run_overrun(int policy, int work) {
+	realtime_t start = {0, 0};
+	realtime_t t_1sec = {1, 0};
+	rt_attr_t attr;
+	reset();
+	overrun_work = work;
+	rt_attr_init(&attr);
+	attr.overrun = policy;
+	CHECK(process_rt_periodic_attr(overrun_task, RT_STACK, &start, &t_1sec, &t_1sec, &attr) == 0);
+	host_stop_at(10000);
+	process_start();
+	host_stop_at(0);
+}
+
+static void test_overrun(void) {
+	realtime_t start = {0, 0};
+	realtime_t t_300msec = {0, 300};
+	realtime_t t_period = {1, 0};
+	process_rt_stats_t stats;
+	//The deadline moves by one period per job (it used to double)
+	reset();
+	overrun_work = 100;
+	CHECK(process_rt_periodic(overrun_task, RT_STACK, &start, &t_300msec, &t_period) == 0);
+	host_stop_at(10000);
+	process_start();
+	host_stop_at(0);
+	CHECK(process_rt_stats(overrun_task, &stats) == 0);
+	CHECK(stats.jobs == 10 && stats.misses == 0);
+	CHECK(stats.lateness_max == -200);
+	CHECK(events[18].when == 9000);
+	//Catch up: every late job runs back to back with its own deadline
+	run_overrun(RT_OVERRUN_CATCHUP, 2500);
+	CHECK(events[2].when == 2500 && events[4].when == 5000 && events[6].when == 7500);
+	CHECK(process_rt_stats(overrun_task, &stats) == 0);
+	CHECK(stats.jobs == 3 && stats.misses == 3 && stats.skipped == 0);
+	CHECK(stats.lateness_max == 7500 - 3000); //The third job was released at 2 s
+	//Skip: the releases that passed while the job ran are dropped
+	run_overrun(RT_OVERRUN_SKIP, 2500);
+	CHECK(events[2].when == 3000 && events[4].when == 6000 && events[6].when == 9000);
+	CHECK(process_rt_stats(overrun_task, &stats) == 0);
+	CHECK(stats.jobs == 3 && stats.skipped == 6);
+	CHECK(stats.lateness_max == 1500);
+	CHECK(stats.start_delay_max == 0);
+	//Immediate: the next job is released when the late one finishes
+	run_overrun(RT_OVERRUN_IMMEDIATE, 2500);
+	CHECK(events[2].when == 2500 && events[4].when == 5000 && events[6].when == 7500);
+	CHECK(process_rt_stats(overrun_task, &stats) == 0);
+	CHECK(stats.jobs == 3 && stats.skipped == 0);
+	CHECK(stats.lateness_max == 1500);
+}
+
+/*-------------------------------------------------------------
+ * Admission control: infeasible task sets are refused with -2
+ *-------------------------------------------------------------*/
+
+static void admit_long(void) {
+	host_run(500);
+}
+
+static void admit_medium(void) {
+	host_run(300);
+}
+
+static void admit_short(void) {
+	host_run(100);
+}
+
+static void admit_once(void) {
+	host_run(20);
+}
+
+/* Creates a periodic process with the given worst-case execution time, deadline and period in ms */
+
+static int create_admitted(void (* f)(void), int wcet, int deadline, int period) {
+	realtime_t start = {0, 0};
+	realtime_t d = {0, deadline};
+	realtime_t p = {0, period};
+	rt_attr_t attr;
+	rt_attr_init(&attr);
+	attr.wcet.msec = wcet;
+	return process_rt_periodic_attr(f, RT_STACK, &start, &d, &p, &attr);
+}
+
+static void test_admission(void) {
+	realtime_t start = {0, 0};
+	realtime_t t_100msec = {0, 100};
+	realtime_t t_200msec = {0, 200};
+	rt_attr_t attr;
+	reset();
+	CHECK(create_admitted(admit_long, 500, 1000, 1000) == 0);
+	CHECK(create_admitted(admit_medium, 300, 1000, 1000) == 0);
+	CHECK(create_admitted(admit_long, 300, 1000, 1000) == -2); //110% utilization
+	CHECK(create_admitted(admit_short, 100, 150, 1000) == 0); //Density over 1 but the demand test passes
+	CHECK(create_admitted(admit_short, 100, 120, 1000) == -2); //200 ms of work due by 150 ms
+	CHECK(create_admitted(admit_short, 200, 100, 1000) == -2); //Can't meet its own deadline
+	CHECK(process_rt_periodic(admit_long, RT_STACK, &start, &t_100msec, &t_100msec) == 0); //Undeclared, not checked
+	host_stop_at(1); //Throws the processes away again
+	process_start();
+	host_stop_at(0);
+	CHECK(process_deadline_met == 0 && process_deadline_miss == 0);
+	reset();
+	CHECK(create_admitted(admit_long, 500, 1000, 1000) == 0); //process_stop emptied the admitted set
+	CHECK(create_admitted(admit_medium, 300, 1000, 1000) == 0);
+	CHECK(create_admitted(admit_short, 100, 150, 1000) == 0);
+	rt_attr_init(&attr);
+	attr.wcet.msec = 60;
+	CHECK(process_rt_create_attr(admit_once, RT_STACK, &start, &t_100msec, &attr) == -2); //160 ms of work due by 150 ms
+	attr.wcet.msec = 20;
+	CHECK(process_rt_create_attr(admit_once, RT_STACK, &start, &t_200msec, &attr) == 0);
+	host_stop_at(3000);
+	process_start();
+	host_stop_at(0);
+	CHECK(process_deadline_miss == 0);
+	CHECK(process_deadline_met == 10); //Three periodic processes for three periods, and the one-shot
+}
+
+/*-------------------------------------------------------------
+ * Release latency: a short periodic job released in the middle of a
+ * time slice preempts a long job right away (RT_EVENT_PREEMPT)
+ *-------------------------------------------------------------*/
+
+static void latency_background(void) {
+	host_run(2000);
+}
+
+static void latency_periodic(void) {
+	host_run(1);
+}
+
+static unsigned int worst_release_delay;
+
+static void test_latency(void) {
+	realtime_t start = {0, 0};
+	realtime_t t_100sec = {100, 0};
+	realtime_t p_start = {0, 3};
+	realtime_t p_period = {0, 7};
+	process_rt_stats_t stats;
+	reset();
+	CHECK(process_rt_create(latency_background, RT_STACK, &start, &t_100sec) == 0);
+	CHECK(process_rt_periodic(latency_periodic, RT_STACK, &p_start, &p_period, &p_period) == 0);
+	host_stop_at(1000);
+	process_start();
+	host_stop_at(0);
+	CHECK(process_rt_stats(latency_periodic, &stats) == 0);
+	worst_release_delay = stats.start_delay_max;
+#if RT_EVENT_PREEMPT
+	CHECK(stats.jobs == 143); //Released at 3, 10, ..., 997
+	CHECK(stats.start_delay_max == 0);
+	CHECK(stats.misses == 0);
+#else
+	CHECK(stats.start_delay_max < RT_SLICE_MS);
+#endif
+}
+
+/*-------------------------------------------------------------
+ * Stacks: the high-water mark follows the stack a process uses, and a
+ * process that runs past the bottom of its stack is stopped at its next
+ * switch without its neighbour noticing
+ *-------------------------------------------------------------*/
+
+static unsigned int stack_marks[2];
+static int overflow_finished;
+
+static void stack_user(void) {
+	host_stack_use(30);
+	stack_marks[0] = process_stack_high_water();
+	host_stack_use(12);
+	host_run(25);
+	stack_marks[1] = process_stack_high_water();
+}
+
+static void stack_overrun(void) {
+	host_stack_use(RT_STACK * 2);
+	host_run(25);
+	overflow_finished = 1;
+}
+
+static void test_stack(void) {
+	unsigned int n = 0;
+	reset();
+	overflow_finished = 0;
+	process_stack_overflows = 0;
+	CHECK(process_create(stack_user, RT_STACK) == 0);
+	CHECK(process_create(stack_overrun, RT_STACK) == 0);
+	process_start();
+	CHECK(stack_marks[0] == 30);
+	CHECK(stack_marks[1] == 30); //Nothing deeper than the first use
+#if RT_STACK_CHECK
+	CHECK(overflow_finished == 0); //Stopped at its first time slice
+	CHECK(process_stack_overflows == 1);
+#endif
+#if RT_STACK_PROFILE
+	CHECK(process_stack_profile(stack_user, &n) == 0);
+	CHECK(n == 30);
+#else
+	(void) n;
+#endif
+}
+
+/*-------------------------------------------------------------
+ * Stack Resource Policy: a job that shares a resource with a job holding
+ * it waits for one critical section before it starts, a job with a
+ * deadline above the ceiling is not held back, and nested locks taken in
+ * opposite orders do not deadlock
+ *-------------------------------------------------------------*/
+
+static rt_resource_t resource_x, resource_y;
+static int lock_failures;
+
+static void lock(rt_resource_t * resource) {
+	if (process_rt_lock(resource) != 0) {
+		lock_failures++;
+	}
+}
+
+static void unlock(rt_resource_t * resource) {
+	if (process_rt_unlock(resource) != 0) {
+		lock_failures++;
+	}
+}
+
+static void srp_low(void) {
+	log_event('S', 1);
+	host_run(100);
+	lock(&resource_x);
+	host_run(300);
+	log_event('U', 1);
+	unlock(&resource_x);
+	host_run(100);
+	log_event('E', 1);
+}
+
+static void srp_high(void) {
+	log_event('S', 2);
+	lock(&resource_x);
+	host_run(50);
+	unlock(&resource_x);
+	log_event('E', 2);
+}
+
+static void srp_medium(void) {
+	log_event('S', 3);
+	host_run(100);
+	log_event('E', 3);
+}
+
+static void srp_urgent(void) {
+	log_event('S', 4);
+	host_run(50);
+	log_event('E', 4);
+}
+
+static void test_srp_blocking(void) {
+	realtime_t start = {0, 0};
+	realtime_t t_5sec = {5, 0};
+	realtime_t high_start = {0, 150}, high_deadline = {1, 0};
+	realtime_t medium_start = {0, 200}, medium_deadline = {2, 0};
+	realtime_t urgent_start = {0, 250}, urgent_deadline = {0, 500};
+	process_rt_stats_t stats;
+	reset();
+	lock_failures = 0;
+	rt_resource_init(&resource_x, &high_deadline);
+	CHECK(process_rt_create(srp_low, RT_STACK, &start, &t_5sec) == 0);
+	CHECK(process_rt_create(srp_high, RT_STACK, &high_start, &high_deadline) == 0);
+	CHECK(process_rt_create(srp_medium, RT_STACK, &medium_start, &medium_deadline) == 0);
+	CHECK(process_rt_create(srp_urgent, RT_STACK, &urgent_start, &urgent_deadline) == 0);
+	process_start();
+	CHECK(lock_failures == 0);
+	CHECK(process_deadline_met == 4);
+	CHECK(event_count == 9);
+	CHECK(events[0].what == 'S' && events[0].who == 1 && events[0].when == 0);
+	CHECK(events[1].what == 'S' && events[1].who == 4 && events[1].when == 250); //Above the ceiling, preempts the critical section
+	CHECK(events[2].what == 'E' && events[2].who == 4 && events[2].when == 300);
+	CHECK(events[3].what == 'U' && events[3].who == 1 && events[3].when == 450);
+	CHECK(events[4].what == 'S' && events[4].who == 2 && events[4].when == 450); //Right at the unlock
+	CHECK(events[5].what == 'E' && events[5].who == 2 && events[5].when == 500);
+	CHECK(events[6].what == 'S' && events[6].who == 3 && events[6].when == 500); //Held back by the ceiling too
+	CHECK(events[7].what == 'E' && events[7].who == 3 && events[7].when == 600);
+	CHECK(events[8].what == 'E' && events[8].who == 1 && events[8].when == 700);
+	//Blocked for no more than the one critical section, on top of the time the urgent job took
+	CHECK(process_rt_stats(srp_high, &stats) == 0);
+	CHECK(stats.start_delay_max - 50 <= 300);
+	CHECK(stats.preemptions == 0);
+	CHECK(process_rt_stats(srp_low, &stats) == 0);
+	CHECK(stats.preemptions == 2); //By the urgent job and at the unlock
+}
+
+static void srp_nest_xy(void) {
+	lock(&resource_x);
+	host_run(100);
+	lock(&resource_y);
+	host_run(100);
+	CHECK(process_rt_unlock(&resource_x) == -1); //Not the last one locked
+	unlock(&resource_y);
+	unlock(&resource_x);
+	log_event('E', 1);
+}
+
+static void srp_nest_yx(void) {
+	lock(&resource_y);
+	host_run(50);
+	lock(&resource_x);
+	host_run(50);
+	unlock(&resource_x);
+	unlock(&resource_y);
+	log_event('E', 2);
+}
+
+static void test_srp_nesting(void) {
+	realtime_t start = {0, 0};
+	realtime_t t_1sec = {1, 0};
+	realtime_t t_2sec = {2, 0};
+	realtime_t late_start = {0, 50};
+	reset();
+	lock_failures = 0;
+	rt_resource_init(&resource_x, &t_1sec);
+	rt_resource_init(&resource_y, &t_1sec);
+	CHECK(process_rt_create(srp_nest_xy, RT_STACK, &start, &t_2sec) == 0);
+	CHECK(process_rt_create(srp_nest_yx, RT_STACK, &late_start, &t_1sec) == 0);
+	process_start();
+	CHECK(lock_failures == 0);
+	CHECK(process_deadline_met == 2);
+	CHECK(event_count == 2);
+	CHECK(events[0].who == 2 && events[0].when == 300); //Starts when the outer unlock lowers the ceiling
+	CHECK(events[1].who == 1 && events[1].when == 300);
+}
+
+/*-------------------------------------------------------------
+ * Sleeping: a periodic job that waits 40 ms for a device each period
+ * leaves the processor to background work if it sleeps instead of
+ * spinning, and wakes up exactly on time
+ *-------------------------------------------------------------*/
+
+#define SLEEP_WAIT 40 /* ms a job waits each period */
+#define SLEEP_WORK 10 /* ms a job computes each period */
+
+static int sleep_instead; /* whether the jobs sleep rather than spin */
+static unsigned int background_ms; /* the time the background process got */
+static tick_t late_wakeups; /* the sum of how late every sleep ended */
+
+static void sleep_job(void) {
+	realtime_t wait = {0, SLEEP_WAIT};
+	tick_t before = host_time();
+	if (sleep_instead) {
+		CHECK(process_sleep_for(&wait) == 0);
+	}
+	else {
+		host_run(SLEEP_WAIT); //Like delay() in utils.c
+	}
+	late_wakeups += host_time() - (before + SLEEP_WAIT);
+	host_run(SLEEP_WORK);
+}
+
+static void background(void) {
+	while (1) {
+		host_run(1);
+		background_ms++;
+	}
+}
+
+static unsigned int run_sleep(int sleep) {
+	realtime_t start = {0, 0};
+	realtime_t period = {0, 100};
+	reset();
+	sleep_instead = sleep;
+	background_ms = 0;
+	late_wakeups = 0;
+	CHECK(process_rt_periodic(sleep_job, RT_STACK, &start, &period, &period) == 0);
+	CHECK(process_create(background, RT_STACK) == 0);
+	host_stop_at(1000);
+	process_start();
+	host_stop_at(0);
+	CHECK(process_deadline_met == 10);
+	CHECK(process_deadline_miss == 0);
+	CHECK(late_wakeups == 0);
+	return background_ms;
+}
+
+static void sleep_alone(void) {
+	realtime_t past = {0, 10};
+	realtime_t until = {0, 75};
+	realtime_t wait = {0, 30};
+	CHECK(process_sleep_until(&past) == 0); //Already over, returns right away
+	log_event('S', 1);
+	CHECK(process_sleep_for(&wait) == 0); //Nothing else to run, the scheduler idles
+	log_event('W', 1);
+	CHECK(process_sleep_until(&until) == 0);
+	log_event('W', 1);
+	lock(&resource_x);
+	CHECK(process_sleep_for(&wait) == -1); //Not while it holds a resource
+	unlock(&resource_x);
+}
+
+static void test_sleep(void) {
+	realtime_t start = {0, 20};
+	realtime_t deadline = {1, 0};
+	unsigned int spinning = run_sleep(0);
+	unsigned int sleeping = run_sleep(1);
+	printf("test_host: background work %u ms spinning, %u ms sleeping\n", spinning, sleeping);
+	//The background process loses the 1 ms it is in the middle of at the stop
+	CHECK(spinning == 1000 - 10 * (SLEEP_WAIT + SLEEP_WORK) - 1);
+	CHECK(sleeping == 1000 - 10 * SLEEP_WORK - 1); //The waits went to the background process
+	reset();
+	lock_failures = 0;
+	rt_resource_init(&resource_x, &deadline);
+	CHECK(process_rt_create(sleep_alone, RT_STACK, &start, &deadline) == 0);
+	process_start();
+	CHECK(lock_failures == 0);
+	CHECK(process_deadline_met == 1);
+	CHECK(event_count == 3);
+	CHECK(events[0].what == 'S' && events[0].when == 20);
+	CHECK(events[1].what == 'W' && events[1].when == 50);
+	CHECK(events[2].what == 'W' && events[2].when == 75);
+	reset();
+	CHECK(process_create(sleep_alone, RT_STACK) == 0); //A non real time process sleeps the same way, from time 0
+	process_start();
+	CHECK(event_count == 3);
+	CHECK(events[0].what == 'S' && events[0].when == 10);
+	CHECK(events[1].what == 'W' && events[1].when == 40);
+	CHECK(events[2].what == 'W' && events[2].when == 75);
+}
+
+/*-------------------------------------------------------------
+ * Execution budgets: a faulty task declares 20 ms per job but runs
+ * 60 ms. Unchecked it makes a well-behaved task miss every deadline;
+ * demoted or suspended at the end of its budget it only hurts itself
+ *-------------------------------------------------------------*/
+
+static unsigned int budget_hooks; /* calls of the budget hook */
+static unsigned int budget_hook_id; /* the process id the hook saw */
+
+static void faulty_task(void) {
+	host_run(60);
+}
+
+static void good_task(void) {
+	host_run(50);
+}
+
+static void count_overrun(void) {
+	budget_hooks++;
+	budget_hook_id = process_id();
+}
+
+static void run_budget(int action, process_rt_stats_t * faulty, process_rt_stats_t * good) {
+	realtime_t start = {0, 0};
+	realtime_t good_start = {0, 10};
+	realtime_t period = {0, 100};
+	realtime_t good_deadline = {0, 90};
+	rt_attr_t attr;
+	reset();
+	budget_hooks = 0;
+	budget_hook_id = 0;
+	rt_attr_init(&attr);
+	attr.wcet.msec = 20;
+	attr.budget_action = action;
+	attr.budget_hook = count_overrun;
+	CHECK(process_rt_periodic_attr(faulty_task, RT_STACK, &start, &period, &period, &attr) == 0);
+	attr.wcet.msec = 50;
+	attr.budget_action = RT_BUDGET_NONE;
+	attr.budget_hook = NULL;
+	CHECK(process_rt_periodic_attr(good_task, RT_STACK, &good_start, &good_deadline, &period, &attr) == 0);
+	host_stop_at(1000);
+	process_start();
+	host_stop_at(0);
+	CHECK(process_rt_stats(faulty_task, faulty) == 0);
+	CHECK(process_rt_stats(good_task, good) == 0);
+}
+
+static void test_budget(void) {
+	process_rt_stats_t faulty, good;
+	run_budget(RT_BUDGET_NONE, &faulty, &good);
+	CHECK(faulty.overruns == 0);
+	CHECK(budget_hooks == 0);
+	CHECK(good.misses > 0); //The overrun cascades
+	run_budget(RT_BUDGET_HOOK, &faulty, &good);
+	CHECK(faulty.overruns >= faulty.jobs); //Every job (and maybe the one still running at the stop)
+	CHECK(budget_hooks == faulty.overruns);
+	CHECK(budget_hook_id == 1); //Called as the faulty process
+	CHECK(good.misses > 0); //Only reported
+	run_budget(RT_BUDGET_SUSPEND, &faulty, &good);
+	CHECK(faulty.jobs == 10);
+	CHECK(faulty.overruns == 10);
+	CHECK(faulty.misses == 10); //Dropped jobs count as misses
+	CHECK(faulty.response_max == 0); //And have no response time
+	CHECK(good.jobs == 10);
+	CHECK(good.misses == 0);
+#if RT_EVENT_PREEMPT
+	CHECK(good.start_delay_max == 11); //Behind the 20 ms budget of the faulty job (and the tick that overran it), from 10 ms
+#else
+	CHECK(good.start_delay_max <= 11 + RT_SLICE_MS); //The action waits for the next PIT0 tick
+#endif
+	run_budget(RT_BUDGET_DEMOTE, &faulty, &good);
+	CHECK(faulty.overruns >= faulty.jobs);
+	CHECK(faulty.misses > 0);
+	CHECK(good.misses == 0);
+#if RT_EVENT_PREEMPT
+	CHECK(good.start_delay_max == 11);
+#endif
+}
+
+/*-------------------------------------------------------------
+ * Deadline policies: a firm job is dropped at its deadline, running or
+ * asleep, and its next job starts from the top; a soft job runs to the
+ * end after its hook has been called at the deadline
+ *-------------------------------------------------------------*/
+
+static unsigned int deadline_hooks; /* calls of the deadline hook */
+static unsigned int deadline_hook_id; /* the process id the hook saw */
+static tick_t deadline_hook_time; /* when the hook was called last */
+static realtime_t firm_sleep; /* how long late_task sleeps */
+
+static void late_task(void) {
+	log_event('S', 1);
+	process_sleep_for(&firm_sleep);
+	log_event('W', 1);
+	host_run(30);
+	log_event('E', 1);
+}
+
+static void count_late(void) {
+	deadline_hooks++;
+	deadline_hook_id = process_id();
+	deadline_hook_time = host_time();
+}
+
+static void run_late(int policy, unsigned int sleep, process_rt_stats_t * stats) {
+	realtime_t start = {0, 0};
+	realtime_t deadline = {0, 20};
+	realtime_t period = {0, 50};
+	rt_attr_t attr;
+	reset();
+	deadline_hooks = 0;
+	deadline_hook_id = 0;
+	firm_sleep.msec = sleep;
+	rt_attr_init(&attr);
+	attr.deadline_policy = policy;
+	attr.deadline_hook = count_late;
+	CHECK(process_rt_periodic_attr(late_task, RT_STACK, &start, &deadline, &period, &attr) == 0);
+	host_stop_at(200);
+	process_start();
+	host_stop_at(0);
+	CHECK(process_rt_stats(late_task, stats) == 0);
+}
+
+/* Counts the events of one kind in the log */
+
+static int count_events(char what) {
+	int i, n = 0;
+	for (i = 0; i < event_count; i++) {
+		n += (events[i].what == what);
+	}
+	return n;
+}
+
+/*-------------------------------------------------------------
+ * Miss ratio under overload: three tasks that each need 12 ms every
+ * 30 ms (a utilization of 1.2). Run to the end, the late jobs push every
+ * later job past its deadline; dropped at their deadlines, the late jobs
+ * give the time to the jobs that can still make it
+ *-------------------------------------------------------------*/
+
+#define OVERLOAD_RUN 3000 /* ms */
+
+static void overload_task(void) {
+	host_run(12);
+}
+
+static void overload_task_2(void) {
+	host_run(12);
+}
+
+static void overload_task_3(void) {
+	host_run(12);
+}
+
+static double run_overload(int policy, unsigned int * aborts) {
+	void (* tasks[3])(void) = {overload_task, overload_task_2, overload_task_3};
+	realtime_t start = {0, 0};
+	realtime_t period = {0, 30};
+	process_rt_stats_t stats;
+	unsigned int jobs = 0, misses = 0;
+	rt_attr_t attr;
+	int i;
+	reset();
+	deadline_hooks = 0;
+	rt_attr_init(&attr);
+	attr.deadline_policy = policy;
+	attr.deadline_hook = count_late;
+	for (i = 0; i < 3; i++) {
+		CHECK(process_rt_periodic_attr(tasks[i], RT_STACK, &start, &period, &period, &attr) == 0);
+	}
+	host_stop_at(OVERLOAD_RUN);
+	process_start();
+	host_stop_at(0);
+	*aborts = 0;
+	for (i = 0; i < 3; i++) {
+		CHECK(process_rt_stats(tasks[i], &stats) == 0);
+		jobs += stats.jobs;
+		misses += stats.misses;
+		*aborts += stats.aborts;
+	}
+	CHECK(jobs > 0);
+	return jobs ? (double) misses / jobs : 0.0;
+}
+
+static void test_deadline(void) {
+	process_rt_stats_t stats;
+	unsigned int aborts;
+	double hard, firm;
+	run_late(RT_DEADLINE_FIRM, 10, &stats); //Dropped while it runs
+	CHECK(stats.jobs == 4);
+	CHECK(stats.aborts == 4);
+	CHECK(stats.misses == 4);
+	CHECK(process_deadline_miss == 4);
+	CHECK(count_events('S') == 4); //Every job starts from the top
+	CHECK(count_events('W') == 4);
+	CHECK(count_events('E') == 0);
+	CHECK(deadline_hooks == 4);
+	CHECK(deadline_hook_id == 1); //Called as the late process
+	run_late(RT_DEADLINE_FIRM, 30, &stats); //Dropped while it sleeps
+	CHECK(stats.aborts == 4);
+	CHECK(count_events('S') == 4);
+	CHECK(count_events('W') == 0);
+	CHECK(deadline_hook_time == 171); //The tick after the deadline, even with nothing running
+	run_late(RT_DEADLINE_SOFT, 10, &stats);
+	CHECK(stats.aborts == 0);
+	CHECK(stats.jobs == 4);
+	CHECK(stats.misses == 4); //Counted when the jobs finish
+	CHECK(stats.lateness_max == 20);
+	CHECK(count_events('E') == 4);
+	CHECK(deadline_hooks == 4);
+#if RT_EVENT_PREEMPT
+	CHECK(deadline_hook_time == 171); //Right at the tick after the deadline of the last job
+#endif
+	run_late(RT_DEADLINE_HARD, 10, &stats);
+	CHECK(stats.misses == 4);
+	CHECK(deadline_hooks == 0); //No timer for hard jobs
+	hard = run_overload(RT_DEADLINE_HARD, &aborts);
+	CHECK(aborts == 0);
+	CHECK(hard > 0.9); //Nearly every job ends up late
+	firm = run_overload(RT_DEADLINE_FIRM, &aborts);
+	CHECK(aborts == deadline_hooks); //Every expired job was dropped
+#if RT_EVENT_PREEMPT
+	CHECK(firm < 0.4); //One job in three is dropped
+#else
+	CHECK(firm < 0.6); //The drop waits for the next PIT0 tick, which can make the following job late too
+#endif
+	printf("test_host: miss ratio at a utilization of 1.2, %.3f hard, %.3f firm (RT_EVENT_PREEMPT %d)\n",
+		hard, firm, RT_EVENT_PREEMPT);
+}
+
+/*-------------------------------------------------------------
+ * Task management through handles: a non real time controller suspends
+ * a periodic task between jobs, resumes it, changes its deadline and
+ * period and kills it; the handle stops working once it is gone
+ *-------------------------------------------------------------*/
+
+static rt_handle_t managed; /* the handle of the managed task */
+static rt_handle_t managed_self; /* the handle the managed task saw for itself */
+
+static void managed_task(void) {
+	managed_self = process_handle();
+	log_event('S', 1);
+	host_run(10);
+}
+
+static void sleep_until_ms(unsigned int ms) {
+	realtime_t when = {ms / 1000, ms % 1000};
+	CHECK(process_sleep_until(&when) == 0);
+}
+
+static void controller(void) {
+	realtime_t short_deadline = {0, 5};
+	realtime_t deadline = {0, 30};
+	realtime_t period = {0, 100};
+	sleep_until_ms(120);
+	CHECK(process_suspend(managed) == 0); //Waiting for its release at 150
+	CHECK(process_suspend(managed) == 0);
+	sleep_until_ms(230);
+	CHECK(process_resume(managed) == 0); //The releases at 150 and 200 are gone, the next one is at 250
+	sleep_until_ms(270);
+	CHECK(process_set_deadline(managed, &short_deadline) == -2); //10 ms of work can't fit in 5
+	CHECK(process_set_deadline(managed, &deadline) == 0);
+	CHECK(process_set_period(managed, &period) == 0); //From the release at 300 on
+	CHECK(process_set_period(RT_HANDLE_NONE, &period) == -1);
+	CHECK(process_set_period(process_handle(), &period) == -1); //Not periodic
+	sleep_until_ms(420);
+	CHECK(process_kill(managed) == 0);
+	CHECK(process_kill(managed) == -1);
+	CHECK(process_resume(managed) == -1);
+	CHECK(process_set_period(managed, &period) == -1);
+}
+
+static void test_manage(void) {
+	realtime_t start = {0, 0};
+	realtime_t period = {0, 50};
+	process_rt_stats_t stats;
+	rt_attr_t attr;
+	rt_handle_t handles[2];
+	int i;
+	reset();
+	managed = RT_HANDLE_NONE;
+	rt_attr_init(&attr);
+	attr.wcet.msec = 10;
+	attr.handle = &managed;
+	CHECK(process_rt_periodic_attr(managed_task, RT_STACK, &start, &period, &period, &attr) == 0);
+	CHECK(managed != RT_HANDLE_NONE);
+	CHECK(process_create(controller, RT_STACK) == 0);
+	process_start(); //Returns once the task is killed
+	CHECK(managed_self == managed);
+	CHECK(event_count == 6);
+	for (i = 0; i < event_count; i++) {
+		CHECK(events[i].what == 'S');
+	}
+	CHECK(events[0].when == 0 && events[1].when == 50 && events[2].when == 100);
+	CHECK(events[3].when == 250 && events[4].when == 300 && events[5].when == 400);
+	CHECK(process_rt_stats(managed_task, &stats) == 0);
+	CHECK(stats.jobs == 6);
+	CHECK(stats.misses == 0);
+	attr.wcet.msec = 0;
+	attr.handle = &handles[0];
+	CHECK(process_rt_create_attr(managed_task, RT_STACK, &start, &period, &attr) == 0);
+	attr.handle = &handles[1];
+	CHECK(process_rt_create_attr(managed_task, RT_STACK, &start, &period, &attr) == 0); //One of the two takes the struct the task had
+	CHECK(((handles[0] & 0xFFFF) == (managed & 0xFFFF)) || ((handles[1] & 0xFFFF) == (managed & 0xFFFF)));
+	CHECK(handles[0] != managed && handles[1] != managed);
+	CHECK(process_resume(managed) == -1);
+	process_start();
+}
+
+/*-------------------------------------------------------------
+ * Taking a process out of the ready queue keeps the others with its
+ * deadline in arrival order
+ *-------------------------------------------------------------*/
+
+static rt_handle_t tied[6]; /* the handles of the tasks with the same deadline */
+
+static void tied_task(void) {
+	log_event('S', process_id());
+	host_run(1);
+}
+
+static void tie_cutter(void) {
+	log_event('S', process_id());
+	CHECK(process_kill(tied[1]) == 0);
+	CHECK(process_kill(tied[4]) == 0);
+}
+
+static void test_remove_ties(void) {
+	realtime_t start = {0, 0};
+	realtime_t deadline = {0, 100};
+	realtime_t cut_deadline = {0, 10};
+	rt_attr_t attr;
+	int i;
+	reset();
+	rt_attr_init(&attr);
+	for (i = 0; i < 6; i++) {
+		attr.handle = &tied[i];
+		CHECK(process_rt_create_attr(tied_task, RT_STACK, &start, &deadline, &attr) == 0);
+	}
+	attr.handle = NULL;
+	CHECK(process_rt_create_attr(tie_cutter, RT_STACK, &start, &cut_deadline, &attr) == 0);
+	process_start();
+	CHECK(event_count == 5);
+	CHECK(events[0].who == 7);
+	CHECK(events[1].who == 1 && events[2].who == 3 && events[3].who == 4 && events[4].who == 6);
+	CHECK(process_deadline_miss == 0);
+}
+
+/*-------------------------------------------------------------
+ * A periodic job that is suspended while it runs finishes first; a non
+ * real time process suspends itself and is resumed by another
+ *-------------------------------------------------------------*/
+
+static void long_periodic(void) {
+	log_event('S', 1);
+	host_run(40);
+	log_event('E', 1);
+}
+
+static void suspender(void) {
+	CHECK(process_suspend(managed) == 0);
+}
+
+static void resumer(void) {
+	CHECK(process_resume(managed) == 0);
+	CHECK(process_resume(managed) == 0); //Not suspended any more, nothing happens
+}
+
+static void self_suspender(void) {
+	managed = process_handle();
+	log_event('S', 2);
+	CHECK(process_suspend(process_handle()) == 0);
+	log_event('W', 2);
+}
+
+static void controller_resume(void) {
+	sleep_until_ms(50);
+	CHECK(process_resume(managed) == 0);
+}
+
+static void test_suspend(void) {
+	realtime_t start = {0, 0};
+	realtime_t period = {0, 100};
+	realtime_t manage_start = {0, 20};
+	realtime_t resume_start = {0, 250};
+	realtime_t short_deadline = {0, 5};
+	rt_attr_t attr;
+	reset();
+	rt_attr_init(&attr);
+	attr.handle = &managed;
+	CHECK(process_rt_periodic_attr(long_periodic, RT_STACK, &start, &period, &period, &attr) == 0);
+	CHECK(process_rt_create(suspender, RT_STACK, &manage_start, &short_deadline) == 0); //Preempts the job at 20
+	CHECK(process_rt_create(resumer, RT_STACK, &resume_start, &short_deadline) == 0);
+	host_stop_at(400);
+	process_start();
+	host_stop_at(0);
+	CHECK(event_count == 4);
+	CHECK(events[0].what == 'S' && events[0].when == 0);
+	CHECK(events[1].what == 'E' && events[1].when == 40); //The job it was in finished
+	CHECK(events[2].what == 'S' && events[2].when == 300);
+	CHECK(events[3].what == 'E' && events[3].when == 340);
+	CHECK(process_deadline_miss == 0);
+	reset();
+	CHECK(process_create(self_suspender, RT_STACK) == 0);
+	CHECK(process_create(controller_resume, RT_STACK) == 0);
+	process_start();
+	CHECK(event_count == 2);
+	CHECK(events[0].what == 'S' && events[0].when == 0);
+	CHECK(events[1].what == 'W' && events[1].when == 50);
+}
+
+/*-------------------------------------------------------------
+ * Basic tasks: jobs that preempt each other nest on the shared stack,
+ * which ends up as deep as the chain and no deeper, no task takes a
+ * stack of its own, a basic job may not sleep, and a task is refused
+ * when the deepest chain would not fit any more
+ *-------------------------------------------------------------*/
+
+static unsigned int basic_mark;
+static unsigned int basic_blocks;
+
+static void basic_long(void) {
+	log_event('S', 1);
+	host_stack_use(40);
+	host_run(100);
+	log_event('E', 1);
+}
+
+static void basic_mid(void) {
+	log_event('S', 2);
+	host_stack_use(30);
+	host_run(30);
+	log_event('E', 2);
+}
+
+static void basic_short(void) {
+	realtime_t nap = {0, 5};
+	pool_stats_t stats;
+	int i;
+	log_event('S', 3);
+	host_stack_use(20);
+	basic_mark = process_stack_high_water();
+	basic_blocks = 0;
+	for (i = 1; process_pool_stats(i, &stats) == 0; i++) {
+		basic_blocks += stats.used;
+	}
+	CHECK(process_sleep_for(&nap) == -1);
+	host_run(10);
+	log_event('E', 3);
+}
+
+static void test_basic(void) {
+	realtime_t start = {0, 0};
+	realtime_t mid_start = {0, 20};
+	realtime_t short_start = {0, 30};
+	realtime_t late_start = {1, 0};
+	realtime_t long_deadline = {0, 400};
+	realtime_t mid_deadline = {0, 100};
+	realtime_t short_deadline = {0, 20};
+	realtime_t other_deadline = {0, 50};
+	rt_attr_t attr;
+	reset();
+	rt_attr_init(&attr);
+	attr.basic = 1;
+	CHECK(process_rt_periodic_attr(basic_long, 40, &start, &long_deadline, &long_deadline, &attr) == 0);
+	CHECK(process_rt_periodic_attr(basic_mid, 30, &mid_start, &mid_deadline, &long_deadline, &attr) == 0);
+	CHECK(process_rt_create_attr(basic_short, 20, &short_start, &short_deadline, &attr) == 0);
+	CHECK(process_rt_create_attr(basic_long, 60, &late_start, &long_deadline, &attr) == 0); //Deepens the chain at its level only
+	CHECK(process_rt_create_attr(basic_short, 80, &late_start, &other_deadline, &attr) == -1); //A new level that does not fit
+	attr.budget_action = RT_BUDGET_DEMOTE;
+	attr.wcet = short_deadline;
+	CHECK(process_rt_create_attr(basic_short, 20, &late_start, &other_deadline, &attr) == -1);
+	host_stop_at(200);
+	process_start();
+	host_stop_at(0);
+	CHECK(event_count == 6);
+	CHECK(events[0].what == 'S' && events[0].who == 1 && events[0].when == 0);
+	CHECK(events[1].what == 'S' && events[1].who == 2 && events[1].when == 20);
+	CHECK(events[2].what == 'S' && events[2].who == 3 && events[2].when == 30);
+	CHECK(events[3].what == 'E' && events[3].who == 3 && events[3].when == 40);
+	CHECK(events[4].what == 'E' && events[4].who == 2 && events[4].when == 60);
+	CHECK(events[5].what == 'E' && events[5].who == 1 && events[5].when == 140);
+	CHECK(basic_mark == 40 + 30 + 20 + 2 * PROCESS_CONTEXT_WORDS); //Each job on top of the stack of the one it preempted
+	CHECK(basic_blocks == 1); //The shared stack
+	CHECK(process_deadline_miss == 0);
+}
+
+/*-------------------------------------------------------------
+ * Basic tasks with the same deadline: a preempted job resumes before a
+ * job with its deadline that was waiting starts, which would have to go
+ * on top of its frame
+ *-------------------------------------------------------------*/
+
+static void basic_tie(void) {
+	log_event('S', process_id());
+	host_run(process_id() == 3 ? 10 : 50);
+	log_event('E', process_id());
+}
+
+static void test_basic_ties(void) {
+	realtime_t start = {0, 0};
+	realtime_t cut_start = {0, 30};
+	realtime_t deadline = {0, 400};
+	realtime_t cut_deadline = {0, 20};
+	rt_attr_t attr;
+	reset();
+	rt_attr_init(&attr);
+	attr.basic = 1;
+	CHECK(process_rt_create_attr(basic_tie, 20, &start, &deadline, &attr) == 0);
+	CHECK(process_rt_create_attr(basic_tie, 20, &start, &deadline, &attr) == 0);
+	CHECK(process_rt_create_attr(basic_tie, 20, &cut_start, &cut_deadline, &attr) == 0);
+	process_start();
+	CHECK(event_count == 6);
+	CHECK(events[0].what == 'S' && events[0].who == 1 && events[0].when == 0);
+	CHECK(events[1].what == 'S' && events[1].who == 3 && events[1].when == 30);
+	CHECK(events[2].what == 'E' && events[2].who == 3 && events[2].when == 40);
+	CHECK(events[3].what == 'E' && events[3].who == 1 && events[3].when == 60); //Not task 2 at 40
+	CHECK(events[4].what == 'S' && events[4].who == 2 && events[4].when == 60);
+	CHECK(events[5].what == 'E' && events[5].who == 2 && events[5].when == 110);
+	CHECK(process_deadline_miss == 0);
+}
+
+/*-------------------------------------------------------------
+ * Basic task levels: the stack a relative deadline needs on the shared
+ * stack is given back when its last task goes, and a task with a new
+ * deadline pending is counted at both
+ *-------------------------------------------------------------*/
+
+static void basic_level(void) {
+	log_event('S', process_id());
+	host_run(5);
+}
+
+static void test_basic_levels(void) {
+	realtime_t start = {0, 0};
+	realtime_t long_deadline = {0, 400};
+	realtime_t mid_deadline = {0, 100};
+	realtime_t short_deadline = {0, 50};
+	rt_handle_t first, second, mid;
+	rt_attr_t attr;
+	reset();
+	rt_attr_init(&attr);
+	attr.basic = 1;
+	attr.handle = &first;
+	CHECK(process_rt_create_attr(basic_level, 100, &start, &long_deadline, &attr) == 0);
+	attr.handle = &second;
+	CHECK(process_rt_create_attr(basic_level, 20, &start, &long_deadline, &attr) == 0);
+	attr.handle = &mid;
+	CHECK(process_rt_create_attr(basic_level, 50, &start, &mid_deadline, &attr) == 0);
+	attr.handle = NULL;
+	CHECK(process_rt_create_attr(basic_level, 30, &start, &short_deadline, &attr) == -1); //100 + 50 + 30 words
+	CHECK(process_kill(first) == 0);
+	CHECK(process_rt_create_attr(basic_level, 30, &start, &short_deadline, &attr) == -1); //The level keeps its largest stack while a task has it
+	CHECK(process_kill(second) == 0);
+	CHECK(process_rt_create_attr(basic_level, 30, &start, &short_deadline, &attr) == 0);
+	CHECK(process_set_deadline(mid, &short_deadline) == 0); //Counted at 100 and 50 until its next job
+	CHECK(process_rt_create_attr(basic_level, 70, &start, &long_deadline, &attr) == -1);
+	process_start();
+	CHECK(event_count == 2);
+	CHECK(process_deadline_miss == 0);
+}
+
+#ifdef RT_TRACE
+
+/*-------------------------------------------------------------
+ * Scheduling trace: drained a few records at a time, the stream has one
+ * header and then exactly the events the job statistics count; records
+ * that are overwritten before they are drained are reported as lost
+ *-------------------------------------------------------------*/
+
+typedef struct {
+	unsigned int records; /* the records in the stream */
+	unsigned int headers; /* the headers in the stream */
+	unsigned int events[TRACE_LOST + 1]; /* the records of each event */
+	unsigned int lost; /* the sum of the TRACE_LOST counts */
+	unsigned int late; /* the TRACE_RELEASE records of jobs put in the ready queue after their arrival time */
+} trace_count_t;
+
+/* Drains the trace in small pieces, counts what is in it and appends it to file (if not NULL) */
+
+static void drain_trace(trace_count_t * count, FILE * file) {
+	unsigned char buf[40];
+	unsigned int n, i;
+	count->records = 0;
+	count->headers = 0;
+	count->lost = 0;
+	count->late = 0;
+	for (i = 0; i <= TRACE_LOST; i++) {
+		count->events[i] = 0;
+	}
+	while ((n = trace_drain(buf, sizeof(buf))) > 0) {
+		i = 0;
+		if ((n >= TRACE_HEADER_SIZE) && (buf[0] == 'R') && (buf[1] == 'T') && (buf[2] == 'T') && (buf[3] == 'R')) {
+			CHECK(buf[4] == TRACE_VERSION && buf[6] == TRACE_RECORD_SIZE);
+			count->headers += 1;
+			i = TRACE_HEADER_SIZE;
+		}
+		for (; i + TRACE_RECORD_SIZE <= n; i += TRACE_RECORD_SIZE) {
+			unsigned int event = buf[i + 4];
+			CHECK(event >= TRACE_RELEASE && event <= TRACE_LOST);
+			if (event <= TRACE_LOST) {
+				count->events[event] += 1;
+			}
+			if (event == TRACE_LOST) {
+				count->lost += buf[i + 6] | (buf[i + 7] << 8);
+			}
+			if ((event == TRACE_RELEASE) && ((buf[i + 6] | buf[i + 7]) != 0)) {
+				count->late += 1;
+			}
+			count->records += 1;
+		}
+		CHECK(i == n);
+		if (file != NULL) {
+			fwrite(buf, 1, n, file);
+		}
+	}
+}
+
+static void test_trace(void) {
+	trace_count_t count;
+	process_rt_stats_t stats;
+	FILE * file = fopen("test_host.trace", "wb");
+	run_overrun(RT_OVERRUN_CATCHUP, 1500);
+	drain_trace(&count, file);
+	if (file != NULL) {
+		fclose(file);
+	}
+	CHECK(process_rt_stats(overrun_task, &stats) == 0);
+	CHECK(count.headers == 1);
+	CHECK(count.lost == 0);
+	CHECK(count.records == trace_head);
+	CHECK(count.events[TRACE_COMPLETE] == stats.jobs);
+	CHECK(count.events[TRACE_MISS] == stats.misses && stats.misses > 0);
+	CHECK(count.events[TRACE_RELEASE] == stats.jobs + 1); //The job cut off by process_stop
+	CHECK(count.late == stats.jobs); //Each job but the first waits for the one before it to finish
+	CHECK(count.events[TRACE_DISPATCH] == stats.jobs + 1);
+	CHECK(count.events[TRACE_IDLE] == 0); //Always behind
+	//A run with more records than the ring holds
+	test_latency();
+	drain_trace(&count, NULL);
+	CHECK(count.headers == 1);
+	CHECK(count.lost > 0);
+	CHECK(count.records - count.events[TRACE_LOST] + count.lost == trace_head);
+}
+
+#endif
+
+/*-------------------------------------------------------------
+ * Simulation throughput
+ *-------------------------------------------------------------*/
+
+static void bench_scenarios(void) {
+	struct timespec t0, t1;
+	unsigned long long selects = 0, switches = 0, select_ns = 0, elided = 0;
+	double seconds;
+	int i, runs = 2000;
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (i = 0; i < runs; i++) {
+		run_r2();
+		selects += host_stats.selects;
+		switches += host_stats.switches;
+		select_ns += host_stats.select_ns;
+		elided += host_stats.elided;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	seconds = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+	printf("test_host: %d scenarios in %.3f s (%.0f per second), %.1f ns per process_select, %llu switches\n",
+		runs, seconds, runs / seconds, (double) select_ns / selects, switches);
+	printf("test_host: %.1f process_select calls per scenario, %.1f PIT0 ticks per scenario returned without one\n",
+		(double) selects / runs, (double) elided / runs);
+}
+
+#ifdef RT_INSTRUMENT
+
+/* Dumps the instrumentation of the last process_start */
+
+static void dump_instr(void) {
+	static const char * names[INSTR_PATHS] = {"switch", "select", "insert", "remove", "release"};
+	instr_sample_t sample;
+	unsigned int i, b, samples = 0;
+	printf("%8s %8s %8s %10s %8s  histogram (log2 ns buckets)\n", "path", "count", "min", "mean", "max");
+	for (i = 0; i < INSTR_PATHS; i++) {
+		const instr_path_t * p = instr_path(i);
+		printf("%8s %8u %8u %10.1f %8u ", names[i], p->count, p->min, p->count ? (double) p->total / p->count : 0.0, p->max);
+		for (b = 0; b < INSTR_BUCKETS; b++) {
+			printf(" %u", p->histogram[b]);
+		}
+		printf("\n");
+	}
+	while (instr_ring_read(&sample)) {
+		samples++;
+	}
+	printf("%u recent samples in the ring\n", samples);
+}
+
+#endif
+
+int main(void) {
+	test_r1();
+	test_r2();
+	test_p1();
+	test_overrun();
+	test_admission();
+	test_latency();
+	test_stack();
+	test_srp_blocking();
+	test_srp_nesting();
+	test_sleep();
+	test_budget();
+	test_deadline();
+	test_manage();
+	test_remove_ties();
+	test_suspend();
+	test_basic();
+	test_basic_ties();
+	test_basic_levels();
+#ifdef RT_TRACE
+	test_trace();
+#endif
+	if (failures == 0) {
+		printf("test_host: all checks passed\n");
+		bench_scenarios();
+		printf("test_host: worst release to run delay %u ms (RT_EVENT_PREEMPT %d)\n", worst_release_delay, RT_EVENT_PREEMPT);
+#ifdef RT_INSTRUMENT
+		dump_instr();
+#endif
+	}
+	return failures;
+}
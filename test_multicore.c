@@ -0,0 +1,114 @@
+/* Host-side tests of partitioned EDF on simulated cores (multicore.h).
+ *
+ * Checks that first-fit decreasing places tasks on the cores the
+ * admission test allows, that every core meets the deadlines of its tasks
+ * while the cores run in parallel threads, and that no job runs on a core
+ * other than its task's.
+ *
+ * Build and run on the host:
+ *   gcc -DRT_HOST -DRT_MULTICORE -pthread -o test_multicore test_multicore.c test_util.c multicore.c process.c 3140_host.c heap.c twheel.c tick.c pool.c instr.c admit.c trace.c && ./test_multicore
+ * Prints every failed check and exits with the number of failures.
+ */
+
+#include <stdio.h>
+#include "multicore.h"
+#include "3140_concur.h"
+#include "admit.h"
+#include "host.h"
+#include "test_util.h"
+
+static int jobs_on[4]; //Jobs that ran on each core
+
+static int wrong_core; //Jobs that ran on a core other than their task's
+
+/* Runs for the execution time of its task, on the core of its task */
+
+static void job(void) {
+	core_task_t * task = core_task();
+	if (task->core != core_id()) {
+		__sync_fetch_and_add(&wrong_core, 1);
+	}
+	__sync_fetch_and_add(&jobs_on[core_id()], 1);
+	host_run(tick_from_realtime(&task->wcet));
+}
+
+/* Fills a periodic task with an implicit deadline */
+
+static void periodic(core_task_t * task, unsigned int wcet, unsigned int period) {
+	core_task_t t = {job, 64, {0, 0}, {0, 0}, {0, 0}, {0, 0}, -2};
+	tick_to_realtime(period, &t.deadline);
+	tick_to_realtime(period, &t.period);
+	tick_to_realtime(wcet, &t.wcet);
+	*task = t;
+}
+
+/* First-fit decreasing puts the 0.6 and 0.3 tasks on core 0 and the 0.5 and 0.2 tasks on core 1 */
+
+static void test_partition(void) {
+	core_task_t tasks[4];
+	periodic(&tasks[0], 30, 100); //0.3
+	periodic(&tasks[1], 60, 100); //0.6
+	periodic(&tasks[2], 20, 100); //0.2
+	periodic(&tasks[3], 50, 100); //0.5
+	CHECK(core_partition(tasks, 4, 2) == 0);
+	CHECK(tasks[1].core == 0);
+	CHECK(tasks[3].core == 1);
+	CHECK(tasks[0].core == 0);
+	CHECK(tasks[2].core == 1);
+	periodic(&tasks[2], 60, 100); //Three 0.6 tasks only fit two cores
+	periodic(&tasks[3], 60, 100);
+	CHECK(core_partition(tasks + 1, 3, 2) == 1);
+	CHECK(core_partition(tasks + 1, 3, 3) == 0);
+}
+
+/* Two cores at 0.9 each meet every deadline, and every job stays on its core */
+
+static void test_run(void) {
+	core_task_t tasks[4];
+	core_stats_t stats[2];
+	periodic(&tasks[0], 30, 100);
+	periodic(&tasks[1], 60, 100);
+	periodic(&tasks[2], 40, 100);
+	periodic(&tasks[3], 50, 100);
+	CHECK(core_partition(tasks, 4, 2) == 0);
+	CHECK(core_run(tasks, 4, 2, 1000, stats) == 0);
+	CHECK(wrong_core == 0);
+	CHECK(stats[0].tasks == 2);
+	CHECK(stats[1].tasks == 2);
+	CHECK(stats[0].jobs_missed == 0);
+	CHECK(stats[1].jobs_missed == 0);
+	CHECK(stats[0].jobs_met == 20);
+	CHECK(stats[1].jobs_met == 20);
+	CHECK(jobs_on[0] == 20);
+	CHECK(jobs_on[1] == 20);
+	CHECK(stats[0].utilization > ADMIT_ONE * 89 / 100);
+	CHECK(stats[0].utilization < ADMIT_ONE * 91 / 100);
+}
+
+/* The same set on one core is refused beyond 1, and core_run reports it */
+
+static void test_overload(void) {
+	core_task_t tasks[4];
+	core_stats_t stats[1];
+	int i;
+	periodic(&tasks[0], 30, 100);
+	periodic(&tasks[1], 60, 100);
+	periodic(&tasks[2], 40, 100);
+	periodic(&tasks[3], 50, 100);
+	for (i = 0; i < 4; i++) {
+		tasks[i].core = 0;
+	}
+	CHECK(core_run(tasks, 4, 1, 1000, stats) == -1);
+	CHECK(stats[0].tasks == 2);
+	CHECK(stats[0].jobs_missed == 0);
+}
+
+int main(void) {
+	test_partition();
+	test_run();
+	test_overload();
+	if (failures == 0) {
+		printf("test_multicore: all checks passed\n");
+	}
+	return failures;
+}
@@ -0,0 +1,161 @@
+#include "utils.h"
+#include "3140_concur.h"
+#include "realtime.h"
+#include "instr.h"
+
+//Test case S1: the context switch (3140.s) with processes that use the FPU.
+//Two processes do float work that the integer process pTick keeps preempting (every 10 ms, 2 ms deadline), and process 2 also preempts process 1,
+//so PendSV switches between FPU processes, from an FPU process to an integer one and back, and with the FPU state of the preempted process
+//still waiting to be stacked (lazy stacking). Every process ends through SVC1, the FPU processes while the FPU is in use.
+//Each FPU process checks its results against the same work done in main before process_start, with no preemption.
+//Expected behavior: the blue LED blinks once for each FPU process that finished (twice).
+//Then the red LED blinks once for each wrong result and the green LED once for each missed deadline; neither should blink.
+//Built with RT_INSTRUMENT, the switch cycle counts (DWT->CYCCNT) are left in switch_min, switch_mean and switch_max.
+
+/*--------------------------*/
+/* Parameters for test case */
+/*--------------------------*/
+
+/* Stack space for processes (an FPU process needs 34 more words) */
+#define RT_STACK  80
+#define RT_FPU_STACK  120
+
+/* Rounds of float work per FPU process */
+#define ROUNDS  2000
+
+/*--------------------------------------*/
+/* Time structs for real-time processes */
+/*--------------------------------------*/
+
+realtime_t t_10sec = {10, 0};
+realtime_t t_9sec = {9, 0};
+realtime_t t_tick_deadline = {0, 2};
+realtime_t t_tick_period = {0, 10};
+
+/* Process start time */
+realtime_t t_pFPU1 = {0, 1};
+realtime_t t_pFPU2 = {0, 300};
+realtime_t t_pTick = {0, 5};
+
+/*------------------*/
+/* Helper functions */
+/*------------------*/
+
+void shortDelay(){delay();}
+
+volatile float seeds[2] = {1.0f, 2.0f}; /* read at run time, so the compiler cannot work out the results itself */
+float expected[2]; /* the results of fpu_work without preemption */
+volatile unsigned int wrong = 0; /* the FPU rounds that came out different */
+volatile unsigned int fpu_done = 0; /* the FPU processes that have finished */
+volatile unsigned int ticks = 0; /* the jobs of pTick */
+
+unsigned int switch_min, switch_mean, switch_max; /* INSTR_SWITCH, in cycles (RT_INSTRUMENT) */
+
+/* One round of float work: eight accumulators, so the compiler keeps
+   values in S16-S31 (the registers PendSV saves) as well as S0-S15 */
+float fpu_work(float seed) {
+	float a = seed, b = seed + 1.0f, c = seed + 2.0f, d = seed + 3.0f;
+	float e = seed + 4.0f, f = seed + 5.0f, g = seed + 6.0f, h = seed + 7.0f;
+	int i;
+	for (i = 0; i < 2000; i++) {
+		a = a * 0.999f + b;
+		b = b * 0.998f + c;
+		c = c * 0.997f + d;
+		d = d * 0.996f + e;
+		e = e * 0.995f + f;
+		f = f * 0.994f + g;
+		g = g * 0.993f + h;
+		h = h * 0.992f + a;
+	}
+	return a + b + c + d + e + f + g + h;
+}
+
+void fpu_rounds(int which) {
+	int i;
+	for (i = 0; i < ROUNDS; i++) {
+		if (fpu_work(seeds[which - 1]) != expected[which - 1]) {
+			wrong++;
+		}
+	}
+	fpu_done++;
+}
+
+/*------------------------
+ * Real-time FPU process 1
+ *------------------------*/
+
+void pFPU1(void) {
+	fpu_rounds(1);
+}
+
+/*------------------------
+ * Real-time FPU process 2
+ *------------------------*/
+
+void pFPU2(void) {
+	fpu_rounds(2);
+}
+
+/*-----------------------------------------------------------
+ * Periodic integer process, stops the run once both are done
+ *-----------------------------------------------------------*/
+
+void pTick(void) {
+	ticks++;
+	if (fpu_done == 2) {
+		process_stop();
+	}
+}
+
+/*--------------------------------------------*/
+/* Main function - start concurrent execution */
+/*--------------------------------------------*/
+int main(void) {
+	int i;
+
+	LED_Initialize();
+	expected[0] = fpu_work(seeds[0]);
+	expected[1] = fpu_work(seeds[1]);
+
+	/* Create processes */
+	if (process_rt_create(pFPU1, RT_FPU_STACK, &t_pFPU1, &t_10sec) < 0) { return -1; }
+	if (process_rt_create(pFPU2, RT_FPU_STACK, &t_pFPU2, &t_9sec) < 0) { return -1; }
+	if (process_rt_periodic(pTick, RT_STACK, &t_pTick, &t_tick_deadline, &t_tick_period) < 0) { return -1; }
+	/* Launch concurrent execution */
+	process_start();
+
+#ifdef RT_INSTRUMENT
+	{
+		const instr_path_t * path = instr_path(INSTR_SWITCH);
+		switch_min = path->min;
+		switch_mean = (path->count > 0) ? (unsigned int) (path->total / path->count) : 0;
+		switch_max = path->max;
+	}
+#endif
+
+	LED_Off();
+	for (i = 0; i < fpu_done; i++) {
+		LEDBlue_On();
+		shortDelay();
+		LED_Off();
+		shortDelay();
+	}
+	while (wrong > 0) {
+		LEDRed_On();
+		shortDelay();
+		LED_Off();
+		shortDelay();
+		wrong--;
+	}
+	while (process_deadline_miss > 0) {
+		LEDGreen_On();
+		shortDelay();
+		LED_Off();
+		shortDelay();
+		process_deadline_miss--;
+	}
+
+	/* Hang out in infinite loop (so we can inspect variables if we want) */
+	while (1);
+	return 0;
+}
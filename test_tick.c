@@ -0,0 +1,83 @@
+/* Host-side unit tests for the tick conversion layer in tick.c.
+ *
+ * Build and run on the host:
+ *   gcc -o test_tick test_tick.c test_util.c tick.c && ./test_tick
+ * Prints every failed check and exits with the number of failures.
+ */
+
+#include <stdio.h>
+#include "tick.h"
+#include "test_util.h"
+
+/* realtime_t to ticks, including unnormalized msec */
+
+static void test_from_realtime(void) {
+	realtime_t t = {0, 0};
+	CHECK(tick_from_realtime(&t) == 0);
+	t.sec = 1; t.msec = 1;
+	CHECK(tick_from_realtime(&t) == 1001);
+	t.sec = 2; t.msec = 2500; //msec >= 1000 is carried into seconds
+	CHECK(tick_from_realtime(&t) == 4500);
+	t.sec = 4294968; t.msec = 0; //sec * 1000 overflows 32 bits (about 49.7 days)
+	CHECK(tick_from_realtime(&t) == 4294968000ULL);
+	t.sec = 0xFFFFFFFF; t.msec = 999; //largest representable realtime_t
+	CHECK(tick_from_realtime(&t) == 0xFFFFFFFFULL * 1000 + 999);
+}
+
+/* ticks to realtime_t, and the round trip */
+
+static void test_to_realtime(void) {
+	realtime_t t;
+	tick_t ticks;
+	tick_to_realtime(0, &t);
+	CHECK(t.sec == 0 && t.msec == 0);
+	tick_to_realtime(10999, &t);
+	CHECK(t.sec == 10 && t.msec == 999);
+	tick_to_realtime(4294967296ULL, &t); //2^32 ms, past the old 32-bit millisecond wrap
+	CHECK(t.sec == 4294967 && t.msec == 296);
+	for (ticks = 0; ticks < 5000000000ULL; ticks += 123456789) {
+		tick_to_realtime(ticks, &t);
+		CHECK(t.msec < 1000);
+		CHECK(tick_from_realtime(&t) == ticks);
+	}
+}
+
+/* Extending a free running 32-bit counter across its wraparound */
+
+static void test_extend(void) {
+	tick_t now = 0;
+	now = tick_extend(now, 5);
+	CHECK(now == 5);
+	now = tick_extend(now, 5); //no time passed
+	CHECK(now == 5);
+	now = tick_extend(now, 0xFFFFFFF0u);
+	CHECK(now == 0xFFFFFFF0ULL);
+	now = tick_extend(now, 0x00000010u); //the counter wrapped
+	CHECK(now == 0x100000010ULL);
+	now = tick_extend(now, 0xFFFFFFFFu);
+	CHECK(now == 0x1FFFFFFFFULL);
+	now = tick_extend(now, 0x00000000u); //wrapped exactly onto 0
+	CHECK(now == 0x200000000ULL);
+	now = tick_extend(now, 0x7FFFFFFFu); //a large step within one period
+	CHECK(now == 0x27FFFFFFFULL);
+}
+
+/* Ordering stays a plain integer compare on both sides of the old wrap */
+
+static void test_compare(void) {
+	realtime_t before = {4294967, 295}; //2^32 - 1 ms
+	realtime_t after = {4294967, 296}; //2^32 ms, which is 0 in 32-bit milliseconds
+	CHECK(tick_from_realtime(&before) < tick_from_realtime(&after));
+	CHECK(tick_from_realtime(&after) - tick_from_realtime(&before) == 1);
+}
+
+int main(void) {
+	test_from_realtime();
+	test_to_realtime();
+	test_extend();
+	test_compare();
+	if (failures == 0) {
+		printf("test_tick: all checks passed\n");
+	}
+	return failures;
+}
@@ -0,0 +1,35 @@
+#include "test_util.h"
+#ifdef RT_HOST
+#include "3140_concur.h"
+#include "realtime.h"
+#include "host.h"
+#endif
+
+int failures = 0;
+
+#ifdef RT_HOST
+
+event_t events[TEST_EVENTS];
+int event_count;
+
+/* Adds an event to the log at the current simulated time */
+
+void log_event(unsigned int what, int who) {
+	if (event_count < TEST_EVENTS) {
+		events[event_count].what = what;
+		events[event_count].who = who;
+		events[event_count].when = host_time();
+		event_count++;
+	}
+}
+
+/* Empties the log and clears the deadline counters and job statistics */
+
+void reset(void) {
+	event_count = 0;
+	process_deadline_met = 0;
+	process_deadline_miss = 0;
+	process_rt_stats_reset();
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef __TEST_UTIL_H__
+#define __TEST_UTIL_H__
+
+/* Check and event log helpers shared by the host tests (test_host.c,
+ * test_cbs.c, test_event.c, test_multicore.c, test_tick.c). A test counts
+ * its failed checks in failures and returns them from main. The event
+ * log needs the host simulation backend (RT_HOST).
+ */
+
+#include <stdio.h>
+
+extern int failures; /* the number of failed checks */
+
+/* Prints a check that does not hold and counts it */
+#define CHECK(cond) do { if (!(cond)) { printf("FAIL line %d: %s\n", __LINE__, #cond); failures++; } } while (0)
+
+#ifdef RT_HOST
+
+#include "tick.h"
+
+#define TEST_EVENTS 64 /* the events the log holds, later ones are not kept */
+
+/* Log of what the processes did, in the order it happened */
+typedef struct {
+	unsigned int what; /* 'S'tart or 'E'nd, or what the process got */
+	int who; /* the process */
+	tick_t when; /* the simulated time */
+} event_t;
+
+extern event_t events[TEST_EVENTS];
+extern int event_count;
+
+/* Adds an event to the log at the current simulated time */
+void log_event(unsigned int what, int who);
+
+/* Empties the log and clears the deadline counters and job statistics */
+void reset(void);
+
+#endif
+
+#endif
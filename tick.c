@@ -0,0 +1,21 @@
+#include "tick.h"
+
+/* Converts a realtime_t to ticks */
+
+tick_t tick_from_realtime(const realtime_t * time) {
+	return (tick_t) time->sec * TICKS_PER_SEC + time->msec; //Widens before multiplying so large sec values don't overflow
+}
+
+/* Converts ticks to a normalized realtime_t */
+
+void tick_to_realtime(tick_t ticks, realtime_t * time) {
+	time->sec = (unsigned int) (ticks / TICKS_PER_SEC);
+	time->msec = (unsigned int) (ticks % TICKS_PER_SEC);
+}
+
+/* Extends a 32-bit counter reading to 64 bits */
+
+tick_t tick_extend(tick_t last, unsigned int count) {
+	unsigned int elapsed = count - (unsigned int) last; //Modulo 2^32, so this is correct across a wrap
+	return last + elapsed;
+}
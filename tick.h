@@ -0,0 +1,32 @@
+#ifndef __TICK_H__
+#define __TICK_H__
+
+#include "realtime.h"
+
+/* Internal time representation of the scheduler.
+ *
+ * All absolute times (arrival times, deadlines, the current time) are kept
+ * as a single 64-bit count of milliseconds since process_start, so that
+ * comparing two times is one integer compare and no msec >= 1000
+ * normalization is ever needed. A 64-bit millisecond count does not wrap
+ * for more than 500 million years. realtime_t is only used at the
+ * realtime.h API boundary and is converted with the functions below.
+ */
+
+typedef unsigned long long tick_t;
+
+#define TICKS_PER_SEC 1000 /* one tick per PIT1 interrupt (1 ms) */
+
+/* Converts a realtime_t (msec may be 1000 or more) to ticks */
+tick_t tick_from_realtime(const realtime_t * time);
+
+/* Converts ticks to a normalized realtime_t (msec < 1000) */
+void tick_to_realtime(tick_t ticks, realtime_t * time);
+
+/* Extends a reading of a free running 32-bit up counter to 64 bits.
+ * last is the previous extended value; the counter must be read at least
+ * once every 2^32 counts for the wraparound to be detected.
+ */
+tick_t tick_extend(tick_t last, unsigned int count);
+
+#endif
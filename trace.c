@@ -0,0 +1,80 @@
+#include "trace.h"
+
+#ifdef RT_TRACE
+
+RT_PERCORE trace_record_t trace_ring[RT_TRACE_SIZE];
+
+RT_PERCORE volatile unsigned int trace_head; /* the number of records ever written */
+
+static RT_PERCORE unsigned int trace_tail; /* the number of records drained or lost */
+
+static RT_PERCORE int trace_header_sent; /* whether the stream of this run has its header */
+
+/* Writes a little-endian field of bytes bytes */
+
+static unsigned char * trace_put(unsigned char * p, unsigned int value, unsigned int bytes) {
+	while (bytes > 0) {
+		*p++ = value & 0xFF;
+		value >>= 8;
+		bytes--;
+	}
+	return p;
+}
+
+/* Writes a record to the stream */
+
+static unsigned char * trace_put_record(unsigned char * p, const trace_record_t * r) {
+	p = trace_put(p, r->time, 4);
+	p = trace_put(p, r->event, 1);
+	p = trace_put(p, r->task, 1);
+	return trace_put(p, r->arg, 2);
+}
+
+/* Empties the ring and starts a new stream */
+
+void trace_reset(void) {
+	trace_head = 0;
+	trace_tail = 0;
+	trace_header_sent = 0;
+}
+
+/* Copies as much of the stream as fits into buf and takes it off the ring */
+
+unsigned int trace_drain(unsigned char * buf, unsigned int size) {
+	unsigned char * p = buf;
+	unsigned int lost = 0;
+	if (!trace_header_sent) {
+		if (size < TRACE_HEADER_SIZE) {
+			return 0;
+		}
+		p = trace_put(p, 'R' | ('T' << 8) | ('T' << 16) | ('R' << 24), 4);
+		p = trace_put(p, TRACE_VERSION, 2);
+		p = trace_put(p, TRACE_RECORD_SIZE, 2);
+		p = trace_put(p, TICKS_PER_SEC, 4);
+		p = trace_put(p, 0, 4);
+		trace_header_sent = 1;
+	}
+	//Keeps one record free for a TRACE_LOST record
+	while ((trace_tail != trace_head) && (p + 2 * TRACE_RECORD_SIZE <= buf + size)) {
+		trace_record_t r;
+		if (trace_head - trace_tail > RT_TRACE_SIZE) { //Overwritten before it could be drained
+			lost += trace_head - trace_tail - RT_TRACE_SIZE;
+			trace_tail = trace_head - RT_TRACE_SIZE;
+			continue;
+		}
+		r = trace_ring[trace_tail & (RT_TRACE_SIZE - 1)];
+		if (trace_head - trace_tail > RT_TRACE_SIZE) { //Overwritten while it was copied
+			continue;
+		}
+		if (lost > 0) {
+			trace_record_t note = {r.time, TRACE_LOST, 0, (lost > 0xFFFF) ? 0xFFFF : lost};
+			p = trace_put_record(p, &note);
+			lost = 0;
+		}
+		p = trace_put_record(p, &r);
+		trace_tail += 1;
+	}
+	return p - buf;
+}
+
+#endif
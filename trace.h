@@ -0,0 +1,108 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+/* Optional binary scheduling trace (build with RT_TRACE).
+ *
+ * The scheduler writes an 8 byte record for every release, dispatch,
+ * preemption, completion, deadline miss and idle period into a RAM ring
+ * of RT_TRACE_SIZE records (rtconfig.h). Writing a record takes a slot
+ * with one atomic increment and stores two words, so it needs no lock and
+ * is safe from process_select and the PIT1 interrupt at once. When the
+ * ring is full the oldest records are overwritten.
+ *
+ * trace_drain() turns the ring into a byte stream that can be read out a
+ * piece at a time while the scheduler runs (from a low priority process,
+ * a debugger or at the end of a run), and trace_decode.c turns a stream
+ * into per-task Gantt timelines, response time histograms and a deadline
+ * miss report on the host.
+ *
+ * Stream format (all fields little-endian):
+ *   header, once at the start of each run (TRACE_HEADER_SIZE bytes):
+ *     "RTTR", version (16 bits), record size (16 bits), ticks per second (32 bits), 0 (32 bits)
+ *   records (TRACE_RECORD_SIZE bytes each):
+ *     time in ticks since process_start (32 bits), event (8 bits), task (8 bits), argument (16 bits)
+ * The task is the process id (process_id() in 3140_concur.h) modulo 256,
+ * 0 for none. A decoder must skip events it does not know, and a new
+ * header starts a new run.
+ *
+ * Without RT_TRACE the TRACE macros expand to nothing.
+ */
+
+#include "rtconfig.h"
+
+#define TRACE_VERSION 2 /* 1: the argument of TRACE_RELEASE was the relative deadline */
+
+#define TRACE_HEADER_SIZE 16
+#define TRACE_RECORD_SIZE 8
+
+/* The events, and what the argument holds */
+#define TRACE_RELEASE 1 /* a job is put in the ready queue (a periodic job that arrived while the one before it ran is put there when that one finishes); the ticks since the job arrived (saturated), so that it arrived at the time of the record minus the argument */
+#define TRACE_DISPATCH 2 /* a process is switched in; 0 */
+#define TRACE_PREEMPT 3 /* a process is switched out before finishing; 0 */
+#define TRACE_COMPLETE 4 /* a job or process finishes; 0 */
+#define TRACE_MISS 5 /* the job that just completed missed its deadline; the lateness in ticks (saturated) */
+#define TRACE_IDLE 6 /* nothing is ready to run; 0 */
+#define TRACE_LOST 7 /* written by trace_drain only: records were overwritten before they were drained; how many (saturated) */
+#define TRACE_SLEEP 8 /* the running process starts to sleep (process_sleep_until), a non real time process waits for an event (event.h) or the running process is suspended (process_suspend); the ticks to its wakeup time (saturated), 0 for the others */
+#define TRACE_WAKE 9 /* a sleeping process, a non real time process that got its event or a process that was suspended while ready is made ready again; 0 */
+#define TRACE_OVERRUN 10 /* the running job has used up its execution budget; the budget action (RT_BUDGET_...) */
+#define TRACE_EXPIRE 11 /* a job of a firm or soft process is unfinished at its deadline (a firm job is dropped, which completes it); the deadline policy (RT_DEADLINE_...) */
+
+typedef struct {
+	unsigned int time; /* ticks since process_start (low 32 bits) */
+	unsigned char event; /* TRACE_RELEASE ... TRACE_EXPIRE */
+	unsigned char task; /* the process id modulo 256, 0 for none */
+	unsigned short arg; /* depends on the event */
+} trace_record_t;
+
+#ifdef RT_TRACE
+
+#include "tick.h"
+#ifndef RT_HOST
+#include <MK64F12.h>
+#endif
+
+extern RT_PERCORE trace_record_t trace_ring[RT_TRACE_SIZE];
+
+extern RT_PERCORE volatile unsigned int trace_head; /* the number of records ever written */
+
+extern RT_PERCORE tick_t current_tick;
+
+/* Writes a record at the current time */
+static inline void trace_write(unsigned int event, unsigned int task, unsigned int arg) {
+	unsigned int slot;
+	trace_record_t * r;
+#ifdef RT_HOST
+	slot = trace_head++;
+#else
+	do { //Takes the slot atomically, the PIT1 interrupt may write a record in the middle of process_select
+		slot = __LDREXW(&trace_head);
+	} while (__STREXW(slot + 1, &trace_head));
+#endif
+	r = &trace_ring[slot & (RT_TRACE_SIZE - 1)];
+	r->time = (unsigned int) current_tick;
+	r->event = event;
+	r->task = task;
+	r->arg = (arg > 0xFFFF) ? 0xFFFF : arg;
+}
+
+#define TRACE(event, task, arg) trace_write((event), (task), (arg))
+#define TRACE_RESET() trace_reset()
+
+/* Empties the ring and starts a new stream (called by process_start) */
+void trace_reset(void);
+
+/* Copies as much of the stream as fits into buf (whole records only) and
+ * takes it off the ring. Returns the number of bytes copied, 0 if there
+ * is nothing new.
+ */
+unsigned int trace_drain(unsigned char * buf, unsigned int size);
+
+#else
+
+#define TRACE(event, task, arg)
+#define TRACE_RESET()
+
+#endif
+
+#endif
@@ -0,0 +1,268 @@
+/* Host-side decoder of the RT_TRACE scheduling trace (see trace.h).
+ *
+ * Reads a trace stream (as written by trace_drain) from a file or from
+ * standard input and prints, for every run in it, a Gantt timeline of
+ * every task ('#' running, '-' arrived and waiting, '!' where a job
+ * finished late, 'x' where a firm job was dropped at its deadline, '.'
+ * idle), the response times of every task (from the arrival of each
+ * job) with a histogram, and every deadline miss.
+ *
+ * Build and run on the host:
+ *   gcc -O2 -o trace_decode trace_decode.c && ./trace_decode [-w columns] [trace file]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace.h"
+
+#define TASKS 256
+#define BINS 10 /* response time histogram bins */
+#define DEADLINE_FIRM 1 /* the TRACE_EXPIRE argument of a job that is dropped (RT_DEADLINE_FIRM in realtime.h) */
+
+typedef struct {
+	int seen; /* whether the task is in the run */
+	int released; /* whether a job is waiting or running */
+	unsigned int release; /* the arrival time of the current job */
+	unsigned int * responses; /* the response time of every job */
+	unsigned int jobs; /* the number of jobs that finished after a release */
+	unsigned int capacity; /* the room in responses */
+	unsigned int misses; /* the number of jobs that finished late or were dropped */
+	char * row; /* the Gantt timeline */
+} task_t;
+
+static task_t tasks[TASKS];
+static char * idle_row;
+static unsigned int columns = 100;
+static unsigned int scale; /* ticks per column */
+
+/* Reads a little-endian field */
+
+static unsigned int get(const unsigned char * p, unsigned int bytes) {
+	unsigned int value = 0;
+	while (bytes > 0) {
+		bytes--;
+		value = (value << 8) | p[bytes];
+	}
+	return value;
+}
+
+static void get_record(const unsigned char * p, trace_record_t * r) {
+	r->time = get(p, 4);
+	r->event = p[4];
+	r->task = p[5];
+	r->arg = get(p + 6, 2);
+}
+
+/* Marks the columns of [from, to] in a row with c, where '!' beats '#' beats '-' beats '.' and ' ' */
+
+static int rank(char c) {
+	return ((c == '!') || (c == 'x')) ? 4 : (c == '#') ? 3 : (c == '-') ? 2 : (c == '.') ? 1 : 0;
+}
+
+static void mark(char * row, unsigned int from, unsigned int to, char c) {
+	unsigned int col;
+	for (col = from / scale; (col <= to / scale) && (col < columns); col++) {
+		if (rank(c) > rank(row[col])) {
+			row[col] = c;
+		}
+	}
+}
+
+static int compare(const void * a, const void * b) {
+	unsigned int x = *(const unsigned int *) a, y = *(const unsigned int *) b;
+	return (x > y) - (x < y);
+}
+
+/* Prints the report of one run */
+
+static void report(int run, const unsigned char * records, unsigned int count, unsigned int record_size, unsigned int version) {
+	trace_record_t r;
+	unsigned int i, t, end = 1, lost = 0, ntasks = 0;
+	int running = -1; /* the task running, -1 for none */
+	unsigned int since = 0; /* when it started running, or the idle time started */
+	int idle = 0;
+	for (i = 0; i < count; i++) {
+		get_record(records + i * record_size, &r);
+		if (r.time + 1 > end) {
+			end = r.time + 1;
+		}
+	}
+	scale = (end + columns - 1) / columns;
+	memset(tasks, 0, sizeof(tasks));
+	idle_row = malloc(columns + 1);
+	memset(idle_row, ' ', columns);
+	idle_row[columns] = 0;
+	for (t = 0; t < TASKS; t++) {
+		tasks[t].row = malloc(columns + 1);
+		memset(tasks[t].row, ' ', columns);
+		tasks[t].row[columns] = 0;
+	}
+	printf("run %d: %u records\n", run, count);
+	printf("deadline misses:\n");
+	for (i = 0; i < count; i++) {
+		task_t * task;
+		get_record(records + i * record_size, &r);
+		task = &tasks[r.task];
+		if ((r.event >= TRACE_RELEASE) && (r.event <= TRACE_MISS) && !task->seen) {
+			task->seen = 1;
+			ntasks++;
+		}
+		switch (r.event) {
+			case TRACE_RELEASE:
+				task->released = 1;
+				task->release = (version >= 2) ? r.time - r.arg : r.time; //Version 1 streams only have the release time
+				break;
+			case TRACE_DISPATCH:
+				if (idle) {
+					mark(idle_row, since, r.time, '.');
+					idle = 0;
+				}
+				running = r.task;
+				since = r.time;
+				break;
+			case TRACE_PREEMPT:
+			case TRACE_SLEEP:
+			case TRACE_COMPLETE:
+				if (running == r.task) {
+					mark(task->row, since, r.time, '#');
+					running = -1;
+				}
+				if ((r.event == TRACE_COMPLETE) && task->released) {
+					mark(task->row, task->release, r.time, '-');
+					if (task->jobs == task->capacity) {
+						task->capacity = task->capacity ? 2 * task->capacity : 64;
+						task->responses = realloc(task->responses, task->capacity * sizeof(unsigned int));
+					}
+					task->responses[task->jobs++] = r.time - task->release;
+					task->released = 0;
+				}
+				break;
+			case TRACE_MISS:
+				task->misses++;
+				mark(task->row, r.time, r.time, '!');
+				printf("  task %u: arrived %u, deadline %u, finished %u (%u late)\n",
+					r.task, task->release, r.time - r.arg, r.time, r.arg);
+				break;
+			case TRACE_EXPIRE:
+				if (r.arg == DEADLINE_FIRM) { //The TRACE_COMPLETE that follows ends the job
+					task->misses++;
+					mark(task->row, r.time, r.time, 'x');
+					printf("  task %u: arrived %u, dropped at deadline %u\n", r.task, task->release, r.time - 1);
+				}
+				break;
+			case TRACE_IDLE:
+				idle = 1;
+				since = r.time;
+				break;
+			case TRACE_LOST:
+				lost += r.arg;
+				break;
+			default: //Newer events are skipped
+				break;
+		}
+	}
+	if (running >= 0) {
+		mark(tasks[running].row, since, end - 1, '#');
+	}
+	for (t = 0; t < TASKS; t++) {
+		if (tasks[t].released) {
+			mark(tasks[t].row, tasks[t].release, end - 1, '-');
+		}
+	}
+	printf("%u tasks, %u ticks, %u records lost, 1 column = %u ticks\n", ntasks, end, lost, scale);
+	for (t = 1; t < TASKS; t++) {
+		if (tasks[t].seen) {
+			printf("  task %3u |%s|\n", t, tasks[t].row);
+		}
+	}
+	printf("  idle     |%s|\n", idle_row);
+	printf("response times (ticks):\n");
+	for (t = 1; t < TASKS; t++) {
+		task_t * task = &tasks[t];
+		unsigned long long total = 0;
+		unsigned int lo, hi, width, b, j, bins[BINS];
+		if (!task->seen || (task->jobs == 0)) {
+			continue;
+		}
+		qsort(task->responses, task->jobs, sizeof(unsigned int), compare);
+		for (j = 0; j < task->jobs; j++) {
+			total += task->responses[j];
+		}
+		lo = task->responses[0];
+		hi = task->responses[task->jobs - 1];
+		printf("  task %u: %u jobs, %u missed, min %u, avg %llu, max %u\n",
+			t, task->jobs, task->misses, lo, total / task->jobs, hi);
+		width = (hi - lo) / BINS + 1;
+		memset(bins, 0, sizeof(bins));
+		for (j = 0; j < task->jobs; j++) {
+			bins[(task->responses[j] - lo) / width] += 1;
+		}
+		for (b = 0; (b < BINS) && (lo + b * width <= hi); b++) {
+			printf("    %6u - %6u %6u ", lo + b * width, lo + (b + 1) * width - 1, bins[b]);
+			for (j = 0; j < bins[b] * 40 / task->jobs; j++) {
+				putchar('*');
+			}
+			putchar('\n');
+		}
+	}
+	for (t = 0; t < TASKS; t++) {
+		free(tasks[t].responses);
+		free(tasks[t].row);
+	}
+	free(idle_row);
+}
+
+int main(int argc, char ** argv) {
+	FILE * in = stdin;
+	unsigned char * data = NULL;
+	size_t size = 0, capacity = 0, n, pos = 0;
+	int i, run = 0;
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "-w") == 0) && (i + 1 < argc)) {
+			columns = atoi(argv[++i]);
+			if (columns == 0) {
+				columns = 100;
+			}
+		}
+		else if ((in = fopen(argv[i], "rb")) == NULL) {
+			perror(argv[i]);
+			return 1;
+		}
+	}
+	do {
+		if (size == capacity) {
+			capacity = capacity ? 2 * capacity : 65536;
+			data = realloc(data, capacity);
+		}
+		n = fread(data + size, 1, capacity - size, in);
+		size += n;
+	} while (n > 0);
+	while (pos + TRACE_HEADER_SIZE <= size) {
+		unsigned int version, record_size;
+		size_t start, count = 0;
+		if (memcmp(data + pos, "RTTR", 4) != 0) {
+			fprintf(stderr, "no trace header at byte %lu\n", (unsigned long) pos);
+			return 1;
+		}
+		version = get(data + pos + 4, 2);
+		record_size = get(data + pos + 6, 2);
+		if ((version > TRACE_VERSION) || (record_size < TRACE_RECORD_SIZE)) {
+			fprintf(stderr, "unsupported trace version %u (record size %u)\n", version, record_size);
+			return 1;
+		}
+		pos += TRACE_HEADER_SIZE;
+		start = pos;
+		while ((pos + record_size <= size) && ((pos + 4 > size) || (memcmp(data + pos, "RTTR", 4) != 0))) { //Up to the next header
+			pos += record_size;
+			count++;
+		}
+		report(++run, data + start, count, record_size, version);
+	}
+	if (run == 0) {
+		fprintf(stderr, "empty trace\n");
+		return 1;
+	}
+	free(data);
+	return 0;
+}
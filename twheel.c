@@ -0,0 +1,228 @@
+#include <stdlib.h>
+#include "twheel.h"
+
+/* Appends node to the end of the list at head */
+
+static void twheel_append(twheel_node_t ** head, twheel_node_t * node) {
+	node->next = NULL;
+	node->list = head;
+	if (*head == NULL) {
+		*head = node;
+		node->prev = node;
+	}
+	else {
+		twheel_node_t * tail = (*head)->prev;
+		tail->next = node;
+		node->prev = tail;
+		(*head)->prev = node;
+	}
+}
+
+/* Puts node in the slot matching how far away it is due */
+
+static void twheel_place(twheel_t * wheel, twheel_node_t * node) {
+	unsigned long long delta;
+	int level;
+	if (node->expires <= wheel->now) { //Already due, released on the next advance
+		twheel_append(&wheel->due, node);
+		return;
+	}
+	delta = node->expires - wheel->now;
+	for (level = 0; level < TWHEEL_LEVELS; level++) {
+		if (delta < (1ULL << (TWHEEL_BITS * (level + 1)))) {
+			unsigned int slot = (node->expires >> (TWHEEL_BITS * level)) & (TWHEEL_SLOTS - 1);
+			twheel_append(&wheel->slots[level][slot], node);
+			wheel->occupied[level] |= 1ULL << slot;
+			return;
+		}
+	}
+	twheel_append(&wheel->overflow, node);
+}
+
+/* Takes the whole list at head and returns it */
+
+static twheel_node_t * twheel_take(twheel_node_t ** head) {
+	twheel_node_t * list = *head;
+	*head = NULL;
+	return list;
+}
+
+/* Returns the position (1 to TWHEEL_SLOTS) after slot of the first occupied slot in bitmap, 0 if none */
+
+static unsigned int twheel_next_slot(unsigned long long bitmap, unsigned int slot) {
+	unsigned int i;
+	if (bitmap == 0) {
+		return 0;
+	}
+	for (i = 1; i <= TWHEEL_SLOTS; i++) {
+		if (bitmap & (1ULL << ((slot + i) & (TWHEEL_SLOTS - 1)))) {
+			return i;
+		}
+	}
+	return 0;
+}
+
+/* Initializes an empty wheel */
+
+void twheel_init(twheel_t * wheel, unsigned long long now) {
+	int level, slot;
+	wheel->now = now;
+	wheel->count = 0;
+	for (level = 0; level < TWHEEL_LEVELS; level++) {
+		wheel->occupied[level] = 0;
+		for (slot = 0; slot < TWHEEL_SLOTS; slot++) {
+			wheel->slots[level][slot] = NULL;
+		}
+	}
+	wheel->overflow = NULL;
+	wheel->due = NULL;
+}
+
+/* Queues node */
+
+void twheel_insert(twheel_t * wheel, twheel_node_t * node) {
+	twheel_place(wheel, node);
+	wheel->count += 1;
+}
+
+/* Takes node off the wheel */
+
+void twheel_remove(twheel_t * wheel, twheel_node_t * node) {
+	twheel_node_t ** head = node->list;
+	if (head == NULL) {
+		return;
+	}
+	if (node == *head) {
+		*head = node->next;
+		if (*head != NULL) {
+			(*head)->prev = node->prev;
+		}
+	}
+	else {
+		node->prev->next = node->next;
+		if (node->next != NULL) {
+			node->next->prev = node->prev;
+		}
+		else {
+			(*head)->prev = node->prev;
+		}
+	}
+	if ((*head == NULL) && (head >= &wheel->slots[0][0]) && (head < &wheel->slots[0][0] + TWHEEL_LEVELS * TWHEEL_SLOTS)) {
+		unsigned int index = head - &wheel->slots[0][0];
+		wheel->occupied[index / TWHEEL_SLOTS] &= ~(1ULL << (index % TWHEEL_SLOTS));
+	}
+	node->next = NULL;
+	node->list = NULL;
+	wheel->count -= 1;
+}
+
+/* Advances the wheel to tick now and returns the nodes that became due */
+
+twheel_node_t * twheel_advance(twheel_t * wheel, unsigned long long now) {
+	twheel_node_t * released = NULL;
+	twheel_node_t * tail = NULL;
+	twheel_node_t * node;
+	do {
+		if ((wheel->now < now) && (wheel->due == NULL) && (now - wheel->now > TWHEEL_SLOTS)) { //A long stretch, skips the ticks where nothing happens
+			unsigned long long next = twheel_next(wheel);
+			if (next - 1 > wheel->now) {
+				wheel->now = (next - 1 < now) ? next - 1 : now;
+			}
+		}
+		if (wheel->now < now) {
+			if (wheel->count == 0) { //Nothing queued, skips straight to now
+				wheel->now = now;
+			}
+			else {
+				unsigned long long tick = wheel->now + 1;
+				unsigned int slot;
+				int level;
+				wheel->now = tick;
+				//Cascades the higher level slots that start at this tick down to the lower levels
+				for (level = 1; (level < TWHEEL_LEVELS) && ((tick & ((1ULL << (TWHEEL_BITS * level)) - 1)) == 0); level++) {
+					slot = (tick >> (TWHEEL_BITS * level)) & (TWHEEL_SLOTS - 1);
+					wheel->occupied[level] &= ~(1ULL << slot);
+					node = twheel_take(&wheel->slots[level][slot]);
+					while (node != NULL) {
+						twheel_node_t * next = node->next;
+						twheel_place(wheel, node);
+						node = next;
+					}
+				}
+				if ((tick & ((1ULL << (TWHEEL_BITS * TWHEEL_LEVELS)) - 1)) == 0) { //The wheel wrapped, rechecks the overflow list
+					node = twheel_take(&wheel->overflow);
+					while (node != NULL) {
+						twheel_node_t * next = node->next;
+						twheel_place(wheel, node);
+						node = next;
+					}
+				}
+				//Everything in the level 0 slot for this tick is due
+				slot = tick & (TWHEEL_SLOTS - 1);
+				wheel->occupied[0] &= ~(1ULL << slot);
+				node = twheel_take(&wheel->slots[0][slot]);
+				if (node != NULL) {
+					if (wheel->due == NULL) {
+						wheel->due = node;
+					}
+					else { //Joins the slot onto the end of the due list
+						twheel_node_t * due_tail = wheel->due->prev;
+						due_tail->next = node;
+						wheel->due->prev = node->prev;
+						node->prev = due_tail;
+					}
+				}
+			}
+		}
+		//Moves the due list onto the end of the released list
+		node = twheel_take(&wheel->due);
+		while (node != NULL) {
+			node->list = NULL;
+			wheel->count -= 1;
+			if (tail == NULL) {
+				released = node;
+			}
+			else {
+				tail->next = node;
+			}
+			tail = node;
+			node = node->next;
+		}
+	} while (wheel->now < now);
+	return released;
+}
+
+/* Returns the earliest tick at which advancing the wheel can release a node */
+
+unsigned long long twheel_next(twheel_t * wheel) {
+	unsigned long long next = TWHEEL_NEVER;
+	unsigned int i;
+	int level;
+	if (wheel->due != NULL) {
+		return wheel->now;
+	}
+	if (wheel->count == 0) {
+		return TWHEEL_NEVER;
+	}
+	//Level 0 slots hold exactly the nodes due on that tick
+	i = twheel_next_slot(wheel->occupied[0], wheel->now & (TWHEEL_SLOTS - 1));
+	if (i != 0) {
+		next = wheel->now + i;
+	}
+	//Higher level slots are cascaded (and may release nodes) when the wheel reaches their start
+	for (level = 1; level < TWHEEL_LEVELS; level++) {
+		unsigned long long base = wheel->now >> (TWHEEL_BITS * level);
+		i = twheel_next_slot(wheel->occupied[level], base & (TWHEEL_SLOTS - 1));
+		if ((i != 0) && (((base + i) << (TWHEEL_BITS * level)) < next)) {
+			next = (base + i) << (TWHEEL_BITS * level);
+		}
+	}
+	//The overflow list is rechecked when the wheel wraps
+	if (wheel->overflow != NULL) {
+		unsigned long long wrap = ((wheel->now >> (TWHEEL_BITS * TWHEEL_LEVELS)) + 1) << (TWHEEL_BITS * TWHEEL_LEVELS);
+		if (wrap < next) {
+			next = wrap;
+		}
+	}
+	return next;
+}
@@ -0,0 +1,61 @@
+#ifndef __TWHEEL_H__
+#define __TWHEEL_H__
+
+/* Hierarchical timing wheel used for the not ready (release) queue.
+ *
+ * Times are absolute ticks (milliseconds). Level 0 has one slot per tick
+ * for the next 64 ticks; each following level covers 64 times the range of
+ * the previous one with slots of 64 times the width. Nodes in a higher
+ * level slot are cascaded down when the wheel reaches the start of that
+ * slot, so every node is moved at most TWHEEL_LEVELS times. Anything past
+ * the last level waits in an overflow list until the wheel wraps.
+ *
+ * insert and remove are O(1); advancing releases N due nodes in O(N) plus
+ * the cascades, and skips over empty stretches of time using the slot
+ * bitmaps.
+ */
+
+#define TWHEEL_BITS 6
+#define TWHEEL_SLOTS (1 << TWHEEL_BITS) /* slots per level */
+#define TWHEEL_LEVELS 4 /* the levels cover 2^24 ticks (about 4.6 hours) */
+
+typedef struct twheel_node {
+	unsigned long long expires; /* the tick at which the node is due */
+	struct twheel_node * next; /* the next node in the slot (or in the due list) */
+	struct twheel_node * prev; /* the previous node in the slot (the head points to the tail) */
+	struct twheel_node ** list; /* the slot the node is queued in, NULL if not queued */
+} twheel_node_t;
+
+typedef struct {
+	unsigned long long now; /* every node due at or before this tick has been released */
+	unsigned int count; /* the number of queued nodes */
+	unsigned long long occupied[TWHEEL_LEVELS]; /* bitmap of non-empty slots in each level */
+	twheel_node_t * slots[TWHEEL_LEVELS][TWHEEL_SLOTS]; /* the slot lists */
+	twheel_node_t * overflow; /* nodes due past the last level */
+	twheel_node_t * due; /* nodes inserted when already due */
+} twheel_t;
+
+/* Initializes an empty wheel starting at tick now */
+void twheel_init(twheel_t * wheel, unsigned long long now);
+
+/* Queues node (node->expires must already be set) */
+void twheel_insert(twheel_t * wheel, twheel_node_t * node);
+
+/* Takes node off the wheel */
+void twheel_remove(twheel_t * wheel, twheel_node_t * node);
+
+/* Advances the wheel to tick now and returns the nodes that became due,
+ * linked through next in release order (NULL if there are none)
+ */
+twheel_node_t * twheel_advance(twheel_t * wheel, unsigned long long now);
+
+/* Returns the earliest tick at which advancing the wheel can release a
+ * node. It may be earlier than the exact due time of a node that still
+ * has to be cascaded down, but never later. Returns wheel->now if nodes are
+ * already due and TWHEEL_NEVER if the wheel is empty.
+ */
+unsigned long long twheel_next(twheel_t * wheel);
+
+#define TWHEEL_NEVER (~0ULL)
+
+#endif
@@ -1,15 +1,15 @@
-#ifndef __UTILS_H__
-#define __UTILS_H__
-
-void LED_Initialize(void);
-void LEDRed_Toggle (void);
-void LEDBlue_Toggle (void);
-void LEDGreen_Toggle (void);
-void LEDRed_On (void);
-void LEDGreen_On (void);
-void LEDBlue_On (void);
-void LED_Off (void);
-void delay (void);
-
-#endif
-
+#ifndef __UTILS_H__
+#define __UTILS_H__
+
+void LED_Initialize(void);
+void LEDRed_Toggle (void);
+void LEDBlue_Toggle (void);
+void LEDGreen_Toggle (void);
+void LEDRed_On (void);
+void LEDGreen_On (void);
+void LEDBlue_On (void);
+void LED_Off (void);
+void delay (void);
+
+#endif
+